@@ -0,0 +1,61 @@
+// Update the display in small steps so loop() is never blocked
+// for long by the I2C bus.
+
+#include <Wire.h>
+#include "SSD1306UTF8.h"
+#include "SSD1306UTF8Wire.h"
+#include "SSD1306UTF8Queued.h"
+
+// 0X3C+SA0 - 0x3C or 0x3D
+#define I2C_ADDRESS 0x3C
+
+// Define proper RST_PIN if required.
+#define RST_PIN -1
+
+// Wire transport with a 256 byte send queue.
+SSD1306UTF8Queued<SSD1306UTF8Wire> oled;
+
+uint32_t last;
+//------------------------------------------------------------------------------
+void setup() {
+  Wire.begin();
+  Wire.setClock(400000L);
+
+#if RST_PIN >= 0
+  oled.begin(&Adafruit128x64, I2C_ADDRESS, RST_PIN);
+#else // RST_PIN >= 0
+  oled.begin(&Adafruit128x64, I2C_ADDRESS);
+#endif // RST_PIN >= 0
+
+  oled.setFont(System5x7);
+  oled.clear();
+  oled.println("ADC0:");
+  oled.println("loop us:");
+  // Send setup and the form before starting.
+  oled.serviceAll();
+}
+//------------------------------------------------------------------------------
+void loop() {
+  uint32_t m = micros();
+  static uint32_t maxLoop = 0;
+  if (m - last >= 100000) {
+    last = m;
+    // Queue the new values, nothing is sent yet.
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%d", analogRead(0));
+    oled.printField(oled.fieldWidth(9), 0, oled.fieldWidth(6), buf,
+                    FIELD_ALIGN_RIGHT);
+    snprintf(buf, sizeof(buf), "%lu", (unsigned long)maxLoop);
+    oled.printField(oled.fieldWidth(9), 1, oled.fieldWidth(6), buf,
+                    FIELD_ALIGN_RIGHT);
+    maxLoop = 0;
+  }
+  // Other work such as sensor polling goes here.
+
+  // Spend at most about one millisecond on the display.
+  oled.serviceMicros(1000);
+  m = micros() - m;
+  if (m > maxLoop) {
+    maxLoop = m;
+  }
+}
@@ -43,9 +43,12 @@ void setup() {
 }
 //------------------------------------------------------------------------------
 void loop() {
-  for (uint8_t i = 0; i < 6; i++) {  
-    oled.clearField(col[i%2], rows*(i/2), 4);    
-    oled.print(analogRead(i));
+  for (uint8_t i = 0; i < 6; i++) {
+    char buf[8];
+    snprintf(buf, sizeof(buf), "%d", analogRead(i));
+    // Overwrite the old value in one pass, no clearField() flicker.
+    oled.printField(col[i%2], rows*(i/2), oled.fieldWidth(4), buf,
+                    FIELD_ALIGN_RIGHT);
   }
   delay(1000);
 }
@@ -0,0 +1,395 @@
+/**
+ * Copyright (c) 2024 mr258876
+ *
+ * This file is part of the Arduino SSD1306UTF8 Library
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * @file GlcdFont.h
+ * @brief Host side model of a SSD1306UTF8 font and its header writer.
+ *
+ * Shared by the command line font tools in this directory.  Plain C++11,
+ * no dependencies beyond the standard library.
+ */
+#ifndef GlcdFont_h
+#define GlcdFont_h
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+//------------------------------------------------------------------------------
+// Values of the font type indicator, see src/fonts/allFonts.h.
+/** ASCII only, fixed width with one padding pixel. */
+const uint16_t GLCD_TYPE_FIXED_PAD = 0;
+/** ASCII only, fixed width without padding. */
+const uint16_t GLCD_TYPE_FIXED = 1;
+/** UTF-8, fixed width ASCII with one padding pixel. */
+const uint16_t GLCD_TYPE_UTF8_FIXED_PAD = 2;
+/** UTF-8, fixed width ASCII without padding. */
+const uint16_t GLCD_TYPE_UTF8_FIXED = 3;
+/** UTF-8, variable width ASCII. */
+const uint16_t GLCD_TYPE_UTF8_VARIABLE = 4;
+/** ASCII only, variable width. */
+const uint16_t GLCD_TYPE_VARIABLE = 5;
+// Bits of the UTF-8 section indicator.
+/** UTF-8 glyphs are fixed width. */
+const uint16_t GLCD_UTF8_FIXED = 0X01;
+/** One blank column follows each UTF-8 glyph. */
+const uint16_t GLCD_UTF8_PADDING = 0X02;
+/** Codepoints in the glyph table are three bytes. */
+const uint16_t GLCD_UTF8_EXT_PLANES = 0X04;
+/** Glyph data addresses are three bytes. */
+const uint16_t GLCD_UTF8_ADDR24 = 0X08;
+/** Glyph table is sorted by codepoint. */
+const uint16_t GLCD_UTF8_SORTED = 0X10;
+//------------------------------------------------------------------------------
+/**
+ * @struct GlcdGlyph
+ * @brief One glyph in font encoding.
+ *
+ * Data is column-page ordered, rows * width bytes, exactly as stored
+ * in the header, including the Thiele shift for variable width sections.
+ */
+struct GlcdGlyph {
+  uint32_t cp = 0;            ///< Codepoint.
+  uint8_t width = 0;          ///< Width in pixels.
+  std::vector<uint8_t> data;  ///< Encoded bitmap.
+};
+//------------------------------------------------------------------------------
+/**
+ * @struct GlcdFont
+ * @brief A complete font ready to be written as a header.
+ */
+struct GlcdFont {
+  std::string name;          ///< C identifier of the font array.
+  uint8_t height = 0;        ///< Height in pixels.
+  bool asciiFixed = true;    ///< ASCII section is fixed width.
+  bool asciiPadding = true;  ///< ASCII glyphs get one blank column.
+  uint8_t asciiWidth = 0;    ///< Maximum ASCII width.
+  uint8_t firstChar = 0;     ///< First character of the ASCII section.
+  /** ASCII glyphs, index is character - firstChar. */
+  std::vector<GlcdGlyph> ascii;
+  bool utf8Fixed = false;    ///< UTF-8 glyphs are fixed width.
+  bool utf8Padding = false;  ///< UTF-8 glyphs get one blank column.
+  uint8_t utf8Width = 0;     ///< Width of fixed width UTF-8 glyphs.
+  /** UTF-8 glyphs, codepoints above 127. */
+  std::vector<GlcdGlyph> utf8;
+  /** @return Number of eight pixel pages in a glyph. */
+  uint8_t rows() const { return (height + 7) / 8; }
+};
+//------------------------------------------------------------------------------
+/**
+ * @struct GlcdLayout
+ * @brief Sizes and flags chosen when a font is serialized.
+ */
+struct GlcdLayout {
+  uint16_t type = 0;          ///< Font type indicator.
+  uint16_t utf8Flags = 0;     ///< UTF-8 section indicator.
+  size_t headerBytes = 0;     ///< Header and width table.
+  size_t asciiDataBytes = 0;  ///< ASCII bitmap bytes.
+  size_t utf8TableBytes = 0;  ///< UTF-8 section header and glyph table.
+  size_t utf8DataBytes = 0;   ///< UTF-8 bitmap bytes.
+  /** @return Total flash used by the font. */
+  size_t total() const {
+    return headerBytes + asciiDataBytes + utf8TableBytes + utf8DataBytes;
+  }
+};
+//------------------------------------------------------------------------------
+/** Append a codepoint as UTF-8. */
+inline void glcdAppendUtf8(std::string* s, uint32_t cp) {
+  if (cp < 0X80) {
+    s->push_back(static_cast<char>(cp));
+  } else if (cp < 0X800) {
+    s->push_back(static_cast<char>(0XC0 | (cp >> 6)));
+    s->push_back(static_cast<char>(0X80 | (cp & 0X3F)));
+  } else if (cp < 0X10000) {
+    s->push_back(static_cast<char>(0XE0 | (cp >> 12)));
+    s->push_back(static_cast<char>(0X80 | ((cp >> 6) & 0X3F)));
+    s->push_back(static_cast<char>(0X80 | (cp & 0X3F)));
+  } else {
+    s->push_back(static_cast<char>(0XF0 | (cp >> 18)));
+    s->push_back(static_cast<char>(0X80 | ((cp >> 12) & 0X3F)));
+    s->push_back(static_cast<char>(0X80 | ((cp >> 6) & 0X3F)));
+    s->push_back(static_cast<char>(0X80 | (cp & 0X3F)));
+  }
+}
+//------------------------------------------------------------------------------
+/**
+ * Decode UTF-8 text into codepoints.  Malformed bytes are skipped.
+ */
+inline void glcdDecodeUtf8(const std::string& s, std::vector<uint32_t>* out) {
+  size_t i = 0;
+  while (i < s.size()) {
+    uint8_t b = s[i];
+    uint32_t cp;
+    size_t n;
+    if (b < 0X80) {
+      cp = b;
+      n = 0;
+    } else if ((b & 0XE0) == 0XC0) {
+      cp = b & 0X1F;
+      n = 1;
+    } else if ((b & 0XF0) == 0XE0) {
+      cp = b & 0X0F;
+      n = 2;
+    } else if ((b & 0XF8) == 0XF0) {
+      cp = b & 0X07;
+      n = 3;
+    } else {
+      i++;
+      continue;
+    }
+    if (i + n >= s.size()) {
+      break;
+    }
+    bool ok = true;
+    for (size_t k = 1; k <= n; k++) {
+      uint8_t c = s[i + k];
+      if ((c & 0XC0) != 0X80) {
+        ok = false;
+        break;
+      }
+      cp = (cp << 6) | (c & 0X3F);
+    }
+    if (!ok) {
+      i++;
+      continue;
+    }
+    out->push_back(cp);
+    i += n + 1;
+  }
+}
+//------------------------------------------------------------------------------
+/** Sort UTF-8 glyphs by codepoint and drop duplicates. */
+inline void glcdSortGlyphs(GlcdFont* font) {
+  std::vector<GlcdGlyph>& v = font->utf8;
+  std::stable_sort(v.begin(), v.end(),
+                   [](const GlcdGlyph& a, const GlcdGlyph& b) {
+                     return a.cp < b.cp;
+                   });
+  v.erase(std::unique(v.begin(), v.end(),
+                      [](const GlcdGlyph& a, const GlcdGlyph& b) {
+                        return a.cp == b.cp;
+                      }),
+          v.end());
+}
+//------------------------------------------------------------------------------
+/**
+ * Serialize a font in the layout described in README.md.
+ *
+ * @param[in] font The font.  UTF-8 glyphs must be sorted.
+ * @param[out] bytes Font bytes.
+ * @param[out] layout Chosen flags and size report.
+ * @param[out] comments Comment for the line that starts at each byte offset.
+ */
+inline void glcdSerialize(const GlcdFont& font, std::vector<uint8_t>* bytes,
+                          GlcdLayout* layout,
+                          std::vector<std::pair<size_t, std::string> >* comments) {
+  bool utf8 = !font.utf8.empty();
+  uint16_t type;
+  if (font.asciiFixed) {
+    type = utf8 ? (font.asciiPadding ? GLCD_TYPE_UTF8_FIXED_PAD
+                                     : GLCD_TYPE_UTF8_FIXED)
+                : (font.asciiPadding ? GLCD_TYPE_FIXED_PAD : GLCD_TYPE_FIXED);
+  } else {
+    type = utf8 ? GLCD_TYPE_UTF8_VARIABLE : GLCD_TYPE_VARIABLE;
+  }
+  uint16_t flags = GLCD_UTF8_SORTED;
+  if (font.utf8Fixed) flags |= GLCD_UTF8_FIXED;
+  if (font.utf8Padding) flags |= GLCD_UTF8_PADDING;
+  for (const GlcdGlyph& g : font.utf8) {
+    if (g.cp > 0XFFFF) flags |= GLCD_UTF8_EXT_PLANES;
+  }
+  uint8_t count = static_cast<uint8_t>(font.ascii.size());
+  size_t header = 6 + (utf8 ? 2 : 0) + (font.asciiFixed ? 0 : count);
+  size_t asciiData = 0;
+  for (const GlcdGlyph& g : font.ascii) asciiData += g.data.size();
+  size_t utf8Data = 0;
+  for (const GlcdGlyph& g : font.utf8) utf8Data += g.data.size();
+  size_t utf8Start = header + asciiData;
+  // Pick 16 or 24 bit addresses from the end of the last glyph.
+  for (int pass = 0; pass < 2; pass++) {
+    size_t metaLen = ((flags & GLCD_UTF8_EXT_PLANES) ? 3 : 2) +
+                     ((flags & GLCD_UTF8_FIXED) ? 0 : 1) +
+                     ((flags & GLCD_UTF8_ADDR24) ? 3 : 2);
+    size_t table = 5 + metaLen * font.utf8.size();
+    if (utf8Start + table + utf8Data > 0X10000) {
+      flags |= GLCD_UTF8_ADDR24;
+    }
+    layout->utf8TableBytes = utf8 ? table : 0;
+  }
+  layout->type = type;
+  layout->utf8Flags = utf8 ? flags : 0;
+  layout->headerBytes = header;
+  layout->asciiDataBytes = asciiData;
+  layout->utf8DataBytes = utf8Data;
+
+  std::vector<uint8_t>& b = *bytes;
+  b.clear();
+  comments->clear();
+  comments->push_back(std::make_pair(b.size(), std::string("type indicator")));
+  b.push_back(type >> 8);
+  b.push_back(type & 0XFF);
+  comments->push_back(std::make_pair(b.size(), std::string("width")));
+  b.push_back(font.asciiWidth);
+  comments->push_back(std::make_pair(b.size(), std::string("height")));
+  b.push_back(font.height);
+  comments->push_back(std::make_pair(b.size(), std::string("first char")));
+  b.push_back(font.firstChar);
+  comments->push_back(std::make_pair(b.size(), std::string("char count")));
+  b.push_back(count);
+  if (utf8) {
+    comments->push_back(
+        std::make_pair(b.size(), std::string("utf8 section start")));
+    b.push_back(utf8Start >> 8);
+    b.push_back(utf8Start & 0XFF);
+  }
+  if (!font.asciiFixed) {
+    comments->push_back(std::make_pair(b.size(), std::string("char widths")));
+    for (const GlcdGlyph& g : font.ascii) b.push_back(g.width);
+  }
+  for (size_t i = 0; i < font.ascii.size(); i++) {
+    char tmp[32];
+    uint8_t ch = font.firstChar + i;
+    if (ch == ' ') {
+      snprintf(tmp, sizeof(tmp), "<space> 0x20");
+    } else {
+      snprintf(tmp, sizeof(tmp), "'%c' 0x%02X", ch, ch);
+    }
+    comments->push_back(std::make_pair(b.size(), std::string(tmp)));
+    const std::vector<uint8_t>& d = font.ascii[i].data;
+    b.insert(b.end(), d.begin(), d.end());
+  }
+  if (!utf8) {
+    return;
+  }
+  comments->push_back(
+      std::make_pair(b.size(), std::string("utf8 type indicator")));
+  b.push_back(flags >> 8);
+  b.push_back(flags & 0XFF);
+  comments->push_back(std::make_pair(b.size(), std::string("utf8 glyph width")));
+  b.push_back(font.utf8Width);
+  comments->push_back(std::make_pair(b.size(), std::string("utf8 glyph count")));
+  b.push_back(font.utf8.size() >> 8);
+  b.push_back(font.utf8.size() & 0XFF);
+  size_t addr = utf8Start + layout->utf8TableBytes;
+  for (const GlcdGlyph& g : font.utf8) {
+    std::string c;
+    glcdAppendUtf8(&c, g.cp);
+    char tmp[32];
+    snprintf(tmp, sizeof(tmp), "   U+%04X", static_cast<unsigned>(g.cp));
+    comments->push_back(std::make_pair(b.size(), c + tmp));
+    if (flags & GLCD_UTF8_EXT_PLANES) b.push_back(g.cp >> 16);
+    b.push_back((g.cp >> 8) & 0XFF);
+    b.push_back(g.cp & 0XFF);
+    if (!(flags & GLCD_UTF8_FIXED)) b.push_back(g.width);
+    if (flags & GLCD_UTF8_ADDR24) b.push_back(addr >> 16);
+    b.push_back((addr >> 8) & 0XFF);
+    b.push_back(addr & 0XFF);
+    addr += g.data.size();
+  }
+  for (const GlcdGlyph& g : font.utf8) {
+    std::string c;
+    glcdAppendUtf8(&c, g.cp);
+    comments->push_back(std::make_pair(b.size(), c));
+    b.insert(b.end(), g.data.begin(), g.data.end());
+  }
+}
+//------------------------------------------------------------------------------
+/**
+ * Write a font as a C header in the style of src/fonts/HelloWorldUTF8.h.
+ *
+ * @param[in] out Output stream.
+ * @param[in] font The font.  UTF-8 glyphs must be sorted.
+ * @param[in] source Description of the source used in the file comment.
+ * @param[out] layout Chosen flags and size report.
+ * @return true for success.
+ */
+inline bool glcdWriteHeader(FILE* out, const GlcdFont& font,
+                            const std::string& source, GlcdLayout* layout) {
+  std::vector<uint8_t> bytes;
+  std::vector<std::pair<size_t, std::string> > comments;
+  glcdSerialize(font, &bytes, layout, &comments);
+  std::string guard;
+  for (char c : font.name) guard.push_back(toupper(c));
+  guard += "_H";
+  fprintf(out, "/*\n *\n * %s\n *\n * Generated from %s\n *\n",
+          font.name.c_str(), source.c_str());
+  fprintf(out, " * File Name           : %s.h\n", font.name.c_str());
+  fprintf(out, " * Font size in bytes  : %u\n",
+          static_cast<unsigned>(layout->total()));
+  fprintf(out, " * Font width          : %u\n", font.asciiWidth);
+  fprintf(out, " * Font height         : %u\n", font.height);
+  fprintf(out, " * Font first char     : %u\n", font.firstChar);
+  if (!font.ascii.empty()) {
+    fprintf(out, " * Font last char      : %u\n",
+            static_cast<unsigned>(font.firstChar + font.ascii.size() - 1));
+  }
+  fprintf(out, " * Font used chars     : %u\n",
+          static_cast<unsigned>(font.ascii.size()));
+  fprintf(out, " * Font utf8 glyphs    : %u\n",
+          static_cast<unsigned>(font.utf8.size()));
+  fprintf(out, " *\n * See README.md for the layout of the font data.\n */\n\n");
+  fprintf(out, "#ifndef %s\n#define %s\n\n", guard.c_str(), guard.c_str());
+  std::string upper = guard.substr(0, guard.size() - 2);
+  fprintf(out, "#define %s_WIDTH %u\n", upper.c_str(), font.asciiWidth);
+  fprintf(out, "#define %s_HEIGHT %u\n\n", upper.c_str(), font.height);
+  fprintf(out, "GLCDFONTDECL(%s) = {\n", font.name.c_str());
+  for (size_t i = 0; i < comments.size(); i++) {
+    size_t bgn = comments[i].first;
+    size_t end = i + 1 < comments.size() ? comments[i + 1].first : bytes.size();
+    if (bgn == end) {
+      continue;
+    }
+    for (size_t k = bgn; k < end; k++) {
+      if ((k - bgn) % 16 == 0) {
+        fprintf(out, (k == bgn) ? "    " : "\n    ");
+      }
+      fprintf(out, "0x%02X,%s", bytes[k], k + 1 < end ? " " : "");
+    }
+    fprintf(out, "  // %s\n", comments[i].second.c_str());
+  }
+  fprintf(out, "};\n\n#endif\n");
+  return !ferror(out);
+}
+//------------------------------------------------------------------------------
+/** Print the flash use of a font. */
+inline void glcdReport(FILE* out, const GlcdFont& font,
+                       const GlcdLayout& layout) {
+  fprintf(out, "%s: %u ASCII + %u UTF-8 glyphs, height %u, %u rows\n",
+          font.name.c_str(), static_cast<unsigned>(font.ascii.size()),
+          static_cast<unsigned>(font.utf8.size()), font.height, font.rows());
+  fprintf(out, "  type %u, utf8 flags 0x%02X\n", layout.type, layout.utf8Flags);
+  fprintf(out, "  header + widths  %6u bytes\n",
+          static_cast<unsigned>(layout.headerBytes));
+  fprintf(out, "  ASCII bitmaps    %6u bytes\n",
+          static_cast<unsigned>(layout.asciiDataBytes));
+  fprintf(out, "  UTF-8 table      %6u bytes\n",
+          static_cast<unsigned>(layout.utf8TableBytes));
+  fprintf(out, "  UTF-8 bitmaps    %6u bytes\n",
+          static_cast<unsigned>(layout.utf8DataBytes));
+  fprintf(out, "  total flash      %6u bytes\n",
+          static_cast<unsigned>(layout.total()));
+}
+#endif  // GlcdFont_h
@@ -0,0 +1,360 @@
+/**
+ * Copyright (c) 2024 mr258876
+ *
+ * This file is part of the Arduino SSD1306UTF8 Library
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * @file bdf2glcd.cpp
+ * @brief Compile a BDF bitmap font into a SSD1306UTF8 font header.
+ *
+ * Build with any C++11 compiler:
+ *
+ *     g++ -std=c++11 -O2 -o bdf2glcd bdf2glcd.cpp
+ *
+ * Usage:
+ *
+ *     bdf2glcd [-n name] [-o out.h] [-c chars.txt] [-t text] [-r first-last]
+ *              [-A] font.bdf
+ *
+ * Printable ASCII, 0X20 - 0X7E, is included unless -A is given.  Other
+ * characters are selected by -c (every character in a UTF-8 text file),
+ * -t (every character in the argument) and -r (a hex codepoint range).
+ * Options may be repeated.
+ *
+ * The tool picks fixed or variable width and padding for each section,
+ * sorts the UTF-8 glyph table, selects 16 or 24 bit codepoints and
+ * addresses, and prints a report of flash use to stderr.
+ *
+ * PCF fonts can be converted to BDF with pcf2bdf first.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+
+#include "GlcdFont.h"
+//------------------------------------------------------------------------------
+/** A BDF glyph rendered into its advance cell. */
+struct Cell {
+  int width = 0;                    // Advance width.
+  std::vector<std::vector<bool> > pixels;  // [y][x], height rows.
+  bool columnBlank(int x) const {
+    for (const std::vector<bool>& row : pixels) {
+      if (row[x]) return false;
+    }
+    return true;
+  }
+};
+//------------------------------------------------------------------------------
+static void usage() {
+  fprintf(stderr,
+          "usage: bdf2glcd [-n name] [-o out.h] [-c chars.txt] [-t text]\n"
+          "                [-r first-last] [-A] font.bdf\n");
+  exit(1);
+}
+//------------------------------------------------------------------------------
+static bool readFile(const char* path, std::string* text) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return false;
+  std::stringstream ss;
+  ss << in.rdbuf();
+  *text = ss.str();
+  return true;
+}
+//------------------------------------------------------------------------------
+/** Load the selected glyphs of a BDF font. */
+static bool loadBdf(const char* path, const std::set<uint32_t>& wanted,
+                    int* height, std::map<uint32_t, Cell>* cells) {
+  std::ifstream in(path);
+  if (!in) {
+    fprintf(stderr, "bdf2glcd: cannot open %s\n", path);
+    return false;
+  }
+  int ascent = -1;
+  int descent = -1;
+  int bbxH = 0;
+  int bbxY = 0;
+  std::string line;
+  long enc = -1;
+  int dwidth = 0;
+  int gw = 0, gh = 0, gx = 0, gy = 0;
+  while (std::getline(in, line)) {
+    std::istringstream ls(line);
+    std::string key;
+    ls >> key;
+    if (key == "FONTBOUNDINGBOX") {
+      int w;
+      ls >> w >> bbxH >> w >> bbxY;
+    } else if (key == "FONT_ASCENT") {
+      ls >> ascent;
+    } else if (key == "FONT_DESCENT") {
+      ls >> descent;
+    } else if (key == "STARTCHAR") {
+      enc = -1;
+      dwidth = 0;
+      gw = gh = gx = gy = 0;
+    } else if (key == "ENCODING") {
+      ls >> enc;
+    } else if (key == "DWIDTH") {
+      ls >> dwidth;
+    } else if (key == "BBX") {
+      ls >> gw >> gh >> gx >> gy;
+    } else if (key == "BITMAP") {
+      if (ascent < 0 || descent < 0) {
+        ascent = bbxH + bbxY;
+        descent = -bbxY;
+      }
+      *height = ascent + descent;
+      bool keep = enc >= 0 && wanted.count(static_cast<uint32_t>(enc));
+      Cell cell;
+      cell.width = dwidth > 0 ? dwidth : gx + gw;
+      cell.pixels.assign(*height, std::vector<bool>(cell.width, false));
+      for (int r = 0; r < gh && std::getline(in, line); r++) {
+        if (!keep) continue;
+        int y = ascent - (gy + gh) + r;
+        for (int x = 0; x < gw; x++) {
+          size_t nib = x / 4;
+          if (nib >= line.size()) break;
+          int v = strtol(std::string(1, line[nib]).c_str(), nullptr, 16);
+          int px = gx + x;
+          if ((v >> (3 - x % 4)) & 1 && y >= 0 && y < *height && px >= 0 &&
+              px < cell.width) {
+            cell.pixels[y][px] = true;
+          }
+        }
+      }
+      if (keep) {
+        (*cells)[static_cast<uint32_t>(enc)] = cell;
+      }
+    }
+  }
+  if (*height <= 0 || *height > 255) {
+    fprintf(stderr, "bdf2glcd: bad font height %d\n", *height);
+    return false;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+/**
+ * Encode a cell in column-page order.
+ *
+ * @param[in] cell Glyph cell.
+ * @param[in] width Columns to encode.
+ * @param[in] thiele Bottom align the last page for variable width sections.
+ */
+static std::vector<uint8_t> encode(const Cell& cell, int width, bool thiele) {
+  int height = cell.pixels.size();
+  int nr = (height + 7) / 8;
+  uint8_t shift = (thiele && (height & 7)) ? 8 - (height & 7) : 0;
+  std::vector<uint8_t> data;
+  for (int r = 0; r < nr; r++) {
+    for (int c = 0; c < width; c++) {
+      uint8_t b = 0;
+      for (int k = 0; k < 8; k++) {
+        int y = 8 * r + k;
+        if (y < height && c < cell.width && cell.pixels[y][c]) b |= 1 << k;
+      }
+      if (r == nr - 1) b <<= shift;
+      data.push_back(b);
+    }
+  }
+  return data;
+}
+//------------------------------------------------------------------------------
+/**
+ * Choose fixed width and padding for a section.  A section is padded if
+ * every glyph ends with a blank column, the column is then dropped and
+ * restored by the renderer.
+ */
+static void chooseSection(const std::vector<const Cell*>& cells, bool* fixed,
+                          bool* padding, int* maxWidth) {
+  *fixed = true;
+  *padding = true;
+  *maxWidth = 0;
+  bool any = false;
+  for (const Cell* c : cells) {
+    if (!c) continue;
+    if (any && c->width != *maxWidth) *fixed = false;
+    if (c->width > *maxWidth) *maxWidth = c->width;
+    if (c->width == 0 || !c->columnBlank(c->width - 1)) *padding = false;
+    any = true;
+  }
+  if (*padding) {
+    (*maxWidth)--;
+  }
+}
+//------------------------------------------------------------------------------
+static bool parseRange(const char* arg, std::set<uint32_t>* wanted) {
+  char* end;
+  unsigned long first = strtoul(arg, &end, 16);
+  unsigned long last = first;
+  if (*end == '-') {
+    last = strtoul(end + 1, &end, 16);
+  }
+  if (*end || last < first || last > 0X10FFFF) return false;
+  for (unsigned long cp = first; cp <= last; cp++) {
+    wanted->insert(cp);
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+int main(int argc, char* argv[]) {
+  GlcdFont font;
+  const char* outPath = nullptr;
+  const char* bdfPath = nullptr;
+  bool ascii = true;
+  std::set<uint32_t> wanted;
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    bool hasArg = i + 1 < argc;
+    if (a == "-n" && hasArg) {
+      font.name = argv[++i];
+    } else if (a == "-o" && hasArg) {
+      outPath = argv[++i];
+    } else if ((a == "-c" || a == "-t") && hasArg) {
+      std::string text;
+      if (a == "-t") {
+        text = argv[++i];
+      } else if (!readFile(argv[++i], &text)) {
+        fprintf(stderr, "bdf2glcd: cannot read %s\n", argv[i]);
+        return 1;
+      }
+      std::vector<uint32_t> cps;
+      glcdDecodeUtf8(text, &cps);
+      for (uint32_t cp : cps) {
+        if (cp >= 0X20) wanted.insert(cp);
+      }
+    } else if (a == "-r" && hasArg) {
+      if (!parseRange(argv[++i], &wanted)) {
+        fprintf(stderr, "bdf2glcd: bad range %s\n", argv[i]);
+        return 1;
+      }
+    } else if (a == "-A") {
+      ascii = false;
+    } else if (a[0] != '-' && !bdfPath) {
+      bdfPath = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if (!bdfPath) usage();
+  if (ascii) {
+    for (uint32_t cp = 0X20; cp < 0X7F; cp++) wanted.insert(cp);
+  }
+  if (font.name.empty()) {
+    std::string base = bdfPath;
+    size_t slash = base.find_last_of("/\\");
+    if (slash != std::string::npos) base = base.substr(slash + 1);
+    size_t dot = base.find('.');
+    if (dot != std::string::npos) base = base.substr(0, dot);
+    for (char c : base) {
+      font.name.push_back(isalnum(static_cast<unsigned char>(c)) ? c : '_');
+    }
+    if (font.name.empty() || isdigit(static_cast<unsigned char>(font.name[0]))) {
+      font.name = "Font_" + font.name;
+    }
+  }
+  int height = 0;
+  std::map<uint32_t, Cell> cells;
+  if (!loadBdf(bdfPath, wanted, &height, &cells)) return 1;
+  for (uint32_t cp : wanted) {
+    if (!cells.count(cp)) {
+      fprintf(stderr, "bdf2glcd: U+%04X not in font\n",
+              static_cast<unsigned>(cp));
+    }
+  }
+  font.height = height;
+
+  // ASCII section, gaps between first and last are filled with blanks.
+  std::vector<const Cell*> asciiCells;
+  std::vector<const Cell*> utf8Cells;
+  uint32_t first = 0X80;
+  uint32_t last = 0;
+  for (const std::pair<const uint32_t, Cell>& e : cells) {
+    if (e.first < 0X80) {
+      first = std::min(first, e.first);
+      last = std::max(last, e.first);
+    } else {
+      utf8Cells.push_back(&e.second);
+    }
+  }
+  if (first > last) {
+    first = 0X20;
+    last = 0X1F;
+  }
+  for (uint32_t cp = first; cp <= last; cp++) {
+    asciiCells.push_back(cells.count(cp) ? &cells[cp] : nullptr);
+  }
+  int asciiWidth;
+  chooseSection(asciiCells, &font.asciiFixed, &font.asciiPadding, &asciiWidth);
+  int utf8Width;
+  chooseSection(utf8Cells, &font.utf8Fixed, &font.utf8Padding, &utf8Width);
+  if (asciiWidth > 255 || utf8Width > 255) {
+    fprintf(stderr, "bdf2glcd: glyph wider than 255 pixels\n");
+    return 1;
+  }
+  if (!font.asciiFixed && !font.asciiPadding) {
+    // Variable width ASCII always gets one blank column from the renderer.
+    fprintf(stderr, "bdf2glcd: note, ASCII glyphs have no blank column\n");
+  }
+  font.asciiWidth = asciiWidth;
+  font.utf8Width = font.utf8Fixed ? utf8Width : 0;
+  font.firstChar = first;
+  Cell blank;
+  blank.pixels.assign(height, std::vector<bool>());
+  for (uint32_t cp = first; cp <= last; cp++) {
+    const Cell* c = asciiCells[cp - first];
+    GlcdGlyph g;
+    g.cp = cp;
+    if (c) {
+      g.width = c->width - (font.asciiPadding ? 1 : 0);
+    } else {
+      g.width = font.asciiFixed ? asciiWidth : 0;
+    }
+    g.data = encode(c ? *c : blank, g.width, !font.asciiFixed);
+    font.ascii.push_back(g);
+  }
+  for (const std::pair<const uint32_t, Cell>& e : cells) {
+    if (e.first < 0X80) continue;
+    GlcdGlyph g;
+    g.cp = e.first;
+    g.width = e.second.width - (font.utf8Padding ? 1 : 0);
+    g.data = encode(e.second, g.width, !font.utf8Fixed);
+    font.utf8.push_back(g);
+  }
+  glcdSortGlyphs(&font);
+
+  FILE* out = outPath ? fopen(outPath, "w") : stdout;
+  if (!out) {
+    fprintf(stderr, "bdf2glcd: cannot create %s\n", outPath);
+    return 1;
+  }
+  GlcdLayout layout;
+  bool ok = glcdWriteHeader(out, font, bdfPath, &layout);
+  if (outPath) ok = fclose(out) == 0 && ok;
+  glcdReport(stderr, font, layout);
+  return ok ? 0 : 1;
+}
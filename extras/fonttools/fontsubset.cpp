@@ -0,0 +1,307 @@
+/**
+ * Copyright (c) 2024 mr258876
+ *
+ * This file is part of the Arduino SSD1306UTF8 Library
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * @file fontsubset.cpp
+ * @brief Cut a UTF-8 font header down to the characters a project uses.
+ *
+ * Build with any C++11 compiler:
+ *
+ *     g++ -std=c++11 -O2 -o fontsubset fontsubset.cpp
+ *
+ * Usage:
+ *
+ *     fontsubset -f font.h [-n name] [-o out.h] [-e .ext,...] path...
+ *
+ * Every path is scanned for codepoints above 127.  Directories are
+ * searched recursively for files with one of the extensions given by -e,
+ * default .c,.cpp,.h,.hpp,.ino,.txt,.json,.po,.csv,.ini,.xml,.yml,.yaml.
+ * Files named on the command line are always scanned.  Besides UTF-8
+ * text, \\uXXXX and \\UXXXXXXXX escapes are recognized.
+ *
+ * The ASCII section of the font is kept intact.  The UTF-8 section keeps
+ * only the glyphs that were found, sorted by codepoint.
+ */
+#include <ctype.h>
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include "GlcdFont.h"
+//------------------------------------------------------------------------------
+static void usage() {
+  fprintf(stderr,
+          "usage: fontsubset -f font.h [-n name] [-o out.h] [-e .ext,...] "
+          "path...\n");
+  exit(1);
+}
+//------------------------------------------------------------------------------
+static bool readFile(const std::string& path, std::string* text) {
+  std::ifstream in(path.c_str(), std::ios::binary);
+  if (!in) return false;
+  std::stringstream ss;
+  ss << in.rdbuf();
+  *text = ss.str();
+  return true;
+}
+//------------------------------------------------------------------------------
+/** Collect codepoints above 127 from UTF-8 text and escapes. */
+static void scanText(const std::string& text, std::set<uint32_t>* used) {
+  std::vector<uint32_t> cps;
+  glcdDecodeUtf8(text, &cps);
+  for (uint32_t cp : cps) {
+    if (cp > 0X7F) used->insert(cp);
+  }
+  for (size_t i = 0; i + 1 < text.size(); i++) {
+    if (text[i] != '\\' || (text[i + 1] != 'u' && text[i + 1] != 'U')) {
+      continue;
+    }
+    size_t n = text[i + 1] == 'u' ? 4 : 8;
+    if (i + 2 + n > text.size()) break;
+    std::string hex = text.substr(i + 2, n);
+    bool ok = true;
+    for (char c : hex) ok = ok && isxdigit(static_cast<unsigned char>(c));
+    if (!ok) continue;
+    uint32_t cp = strtoul(hex.c_str(), nullptr, 16);
+    if (cp > 0X7F && cp <= 0X10FFFF) used->insert(cp);
+  }
+}
+//------------------------------------------------------------------------------
+static bool hasExtension(const std::string& path,
+                         const std::vector<std::string>& exts) {
+  size_t dot = path.find_last_of('.');
+  if (dot == std::string::npos) return false;
+  std::string ext = path.substr(dot);
+  for (char& c : ext) c = tolower(static_cast<unsigned char>(c));
+  for (const std::string& e : exts) {
+    if (e == ext) return true;
+  }
+  return false;
+}
+//------------------------------------------------------------------------------
+static void scanPath(const std::string& path, bool named,
+                     const std::vector<std::string>& exts,
+                     std::set<uint32_t>* used, size_t* files) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    fprintf(stderr, "fontsubset: cannot access %s\n", path.c_str());
+    return;
+  }
+  if (S_ISDIR(st.st_mode)) {
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return;
+    while (struct dirent* e = readdir(dir)) {
+      if (e->d_name[0] == '.') continue;
+      scanPath(path + "/" + e->d_name, false, exts, used, files);
+    }
+    closedir(dir);
+  } else if (named || hasExtension(path, exts)) {
+    std::string text;
+    if (readFile(path, &text)) {
+      scanText(text, used);
+      (*files)++;
+    }
+  }
+}
+//------------------------------------------------------------------------------
+/** Extract the name and bytes of the first GLCDFONTDECL in a header. */
+static bool parseHeader(const std::string& text, std::string* name,
+                        std::vector<uint8_t>* bytes) {
+  size_t p = text.find("GLCDFONTDECL(");
+  if (p == std::string::npos) return false;
+  p += strlen("GLCDFONTDECL(");
+  size_t close = text.find(')', p);
+  if (close == std::string::npos) return false;
+  *name = text.substr(p, close - p);
+  p = text.find('{', close);
+  if (p == std::string::npos) return false;
+  for (p++; p < text.size(); p++) {
+    char c = text[p];
+    if (c == '}') return true;
+    if (c == '/' && p + 1 < text.size() && text[p + 1] == '/') {
+      p = text.find('\n', p);
+      if (p == std::string::npos) return false;
+    } else if (c == '/' && p + 1 < text.size() && text[p + 1] == '*') {
+      p = text.find("*/", p + 2);
+      if (p == std::string::npos) return false;
+      p++;
+    } else if (isdigit(static_cast<unsigned char>(c))) {
+      char* end;
+      unsigned long v = strtoul(text.c_str() + p, &end, 0);
+      if (v > 0XFF) return false;
+      bytes->push_back(static_cast<uint8_t>(v));
+      p = end - text.c_str() - 1;
+    }
+  }
+  return false;
+}
+//------------------------------------------------------------------------------
+static uint32_t rd(const std::vector<uint8_t>& b, size_t i, size_t n) {
+  uint32_t v = 0;
+  for (size_t k = 0; k < n; k++) v = (v << 8) | b.at(i + k);
+  return v;
+}
+//------------------------------------------------------------------------------
+/** Decode font bytes into the host model. */
+static bool decodeFont(const std::vector<uint8_t>& b, GlcdFont* font) {
+  uint16_t type = rd(b, 0, 2);
+  if (type < GLCD_TYPE_UTF8_FIXED_PAD || type > GLCD_TYPE_UTF8_VARIABLE) {
+    return false;
+  }
+  font->asciiFixed = type != GLCD_TYPE_UTF8_VARIABLE;
+  font->asciiPadding = type != GLCD_TYPE_UTF8_FIXED;
+  font->asciiWidth = b.at(2);
+  font->height = b.at(3);
+  font->firstChar = b.at(4);
+  uint8_t count = b.at(5);
+  size_t utf8 = rd(b, 6, 2);
+  uint8_t nr = font->rows();
+  size_t widths = 8;
+  size_t data = widths + (font->asciiFixed ? 0 : count);
+  for (uint8_t i = 0; i < count; i++) {
+    GlcdGlyph g;
+    g.cp = font->firstChar + i;
+    g.width = font->asciiFixed ? font->asciiWidth : b.at(widths + i);
+    size_t n = static_cast<size_t>(g.width) * nr;
+    g.data.assign(b.begin() + data, b.begin() + data + n);
+    data += n;
+    font->ascii.push_back(g);
+  }
+  uint16_t flags = rd(b, utf8, 2);
+  font->utf8Fixed = flags & GLCD_UTF8_FIXED;
+  font->utf8Padding = flags & GLCD_UTF8_PADDING;
+  font->utf8Width = b.at(utf8 + 2);
+  uint16_t n = rd(b, utf8 + 3, 2);
+  size_t cpLen = (flags & GLCD_UTF8_EXT_PLANES) ? 3 : 2;
+  size_t addrLen = (flags & GLCD_UTF8_ADDR24) ? 3 : 2;
+  size_t metaLen = cpLen + (font->utf8Fixed ? 0 : 1) + addrLen;
+  for (uint16_t i = 0; i < n; i++) {
+    size_t m = utf8 + 5 + i * metaLen;
+    GlcdGlyph g;
+    g.cp = rd(b, m, cpLen);
+    g.width = font->utf8Fixed ? font->utf8Width : b.at(m + cpLen);
+    size_t addr = rd(b, m + metaLen - addrLen, addrLen);
+    size_t len = static_cast<size_t>(g.width) * nr;
+    if (addr + len > b.size()) return false;
+    g.data.assign(b.begin() + addr, b.begin() + addr + len);
+    font->utf8.push_back(g);
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+int main(int argc, char* argv[]) {
+  const char* fontPath = nullptr;
+  const char* outPath = nullptr;
+  std::string name;
+  std::vector<std::string> exts = {".c",  ".cpp", ".h",   ".hpp", ".ino",
+                                   ".txt", ".json", ".po",  ".csv", ".ini",
+                                   ".xml", ".yml",  ".yaml"};
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    bool hasArg = i + 1 < argc;
+    if (a == "-f" && hasArg) {
+      fontPath = argv[++i];
+    } else if (a == "-n" && hasArg) {
+      name = argv[++i];
+    } else if (a == "-o" && hasArg) {
+      outPath = argv[++i];
+    } else if (a == "-e" && hasArg) {
+      exts.clear();
+      std::stringstream ss(argv[++i]);
+      std::string e;
+      while (std::getline(ss, e, ',')) {
+        if (!e.empty()) exts.push_back(e[0] == '.' ? e : "." + e);
+      }
+    } else if (a[0] != '-') {
+      paths.push_back(a);
+    } else {
+      usage();
+    }
+  }
+  if (!fontPath || paths.empty()) usage();
+
+  std::string text;
+  std::vector<uint8_t> bytes;
+  GlcdFont font;
+  if (!readFile(fontPath, &text) || !parseHeader(text, &font.name, &bytes)) {
+    fprintf(stderr, "fontsubset: no GLCDFONTDECL array in %s\n", fontPath);
+    return 1;
+  }
+  if (!decodeFont(bytes, &font)) {
+    fprintf(stderr, "fontsubset: %s is not a valid UTF-8 font\n", fontPath);
+    return 1;
+  }
+  size_t oldSize = bytes.size();
+  size_t oldCount = font.utf8.size();
+  if (!name.empty()) font.name = name;
+
+  std::set<uint32_t> used;
+  size_t files = 0;
+  for (const std::string& p : paths) scanPath(p, true, exts, &used, &files);
+
+  std::vector<GlcdGlyph> keep;
+  std::set<uint32_t> found;
+  for (const GlcdGlyph& g : font.utf8) {
+    if (used.count(g.cp) && !found.count(g.cp)) {
+      keep.push_back(g);
+      found.insert(g.cp);
+    }
+  }
+  for (uint32_t cp : used) {
+    if (!found.count(cp)) {
+      std::string c;
+      glcdAppendUtf8(&c, cp);
+      fprintf(stderr, "fontsubset: U+%04X %s is not in the font\n",
+              static_cast<unsigned>(cp), c.c_str());
+    }
+  }
+  font.utf8 = keep;
+  glcdSortGlyphs(&font);
+
+  FILE* out = outPath ? fopen(outPath, "w") : stdout;
+  if (!out) {
+    fprintf(stderr, "fontsubset: cannot create %s\n", outPath);
+    return 1;
+  }
+  GlcdLayout layout;
+  bool ok = glcdWriteHeader(out, font, std::string("subset of ") + fontPath,
+                            &layout);
+  if (outPath) ok = fclose(out) == 0 && ok;
+  fprintf(stderr, "scanned %u files, %u codepoints used\n",
+          static_cast<unsigned>(files), static_cast<unsigned>(used.size()));
+  fprintf(stderr, "kept %u of %u UTF-8 glyphs, %u of %u bytes\n",
+          static_cast<unsigned>(font.utf8.size()),
+          static_cast<unsigned>(oldCount),
+          static_cast<unsigned>(layout.total()),
+          static_cast<unsigned>(oldSize));
+  glcdReport(stderr, font, layout);
+  return ok ? 0 : 1;
+}
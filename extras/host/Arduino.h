@@ -0,0 +1,84 @@
+/**
+ * @file Arduino.h
+ * @brief Minimal Arduino API for building the library on a host.
+ *
+ * Only what the library and the host examples use is provided.
+ */
+#ifndef Arduino_h
+#define Arduino_h
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#define OUTPUT 1
+#define LOW 0
+#define HIGH 1
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline unsigned long micros() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(
+             steady_clock::now().time_since_epoch()).count();
+}
+inline unsigned long millis() { return micros() / 1000; }
+inline void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+inline void yield() { std::this_thread::yield(); }
+
+class String {
+ public:
+  String(const char* s = "") : m_s(s) {}
+  const char* c_str() const { return m_s.c_str(); }
+
+ private:
+  std::string m_s;
+};
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size-- && write(*buffer++)) {
+      n++;
+    }
+    return n;
+  }
+  size_t write(const char* str) {
+    return str ? write((const uint8_t*)str, strlen(str)) : 0;
+  }
+  size_t write(const char* buffer, size_t size) {
+    return write((const uint8_t*)buffer, size);
+  }
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(long n, int base = 10) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), base == 16 ? "%lX" : "%ld", n);
+    return write(buf);
+  }
+  size_t print(int n, int base = 10) { return print((long)n, base); }
+  size_t print(unsigned n, int base = 10) { return print((long)n, base); }
+  size_t print(unsigned long n, int base = 10) { return print((long)n, base); }
+  size_t print(double d, int digits = 2) {
+    char buf[40];
+    snprintf(buf, sizeof(buf), "%.*f", digits, d);
+    return write(buf);
+  }
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(T v) {
+    size_t n = print(v);
+    return n + println();
+  }
+};
+#endif  // Arduino_h
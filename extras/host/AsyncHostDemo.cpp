@@ -0,0 +1,70 @@
+// Render text with the worker thread transport and print the display RAM.
+//
+// Build from the library folder:
+// g++ -std=gnu++11 -pthread -Iextras/host -Isrc extras/host/AsyncHostDemo.cpp
+//     src/SSD1306UTF8.cpp
+#include "SSD1306UTF8Thread.h"
+
+// Page addressing model of the controller RAM.
+static uint8_t ram[8][128];
+static uint8_t col = 0;
+static uint8_t page = 0;
+static uint8_t args = 0;
+
+static void sink(const uint8_t* buf, uint8_t n, uint8_t mode) {
+  for (uint8_t i = 0; i < n; i++) {
+    uint8_t b = buf[i];
+    if (mode != SSD1306_MODE_CMD) {
+      if (col < 128) {
+        ram[page][col] = b;
+      }
+      col++;
+    } else if (args) {
+      args--;
+    } else if (b < 0X10) {
+      col = (col & 0XF0) | b;
+    } else if (b < 0X20) {
+      col = (col & 0X0F) | (b << 4);
+    } else if ((b & 0XF8) == 0XB0) {
+      page = b & 7;
+    } else if (b == 0X21 || b == 0X22) {
+      args = 2;
+    } else if (b == 0X20 || b == 0X81 || b == 0X8D || b == 0XA8 ||
+               b == 0XD3 || b == 0XD5 || b == 0XD9 || b == 0XDA ||
+               b == 0XDB) {
+      args = 1;
+    }
+  }
+}
+
+int main() {
+  SSD1306UTF8Thread oled;
+  // About 400 kHz I2C.
+  oled.begin(&Adafruit128x64, sink, 25);
+  oled.wait();
+  oled.setFont(Adafruit5x7);
+
+  unsigned long t0 = micros();
+  oled.clear();
+  oled.println("Async transport");
+  oled.set2X();
+  oled.printf("%5.1f", 23.4);
+  oled.set1X();
+  oled.println();
+  oled.println("Rendered while the");
+  oled.println("previous block is");
+  oled.print("on the wire.");
+  unsigned long t1 = micros();
+  oled.wait();
+  unsigned long t2 = micros();
+
+  for (uint8_t y = 0; y < 64; y++) {
+    for (uint8_t x = 0; x < 128; x++) {
+      putchar(ram[y / 8][x] >> (y % 8) & 1 ? '#' : '.');
+    }
+    putchar('\n');
+  }
+  printf("render %lu us, render and send %lu us\n", t1 - t0, t2 - t0);
+  oled.end();
+  return 0;
+}
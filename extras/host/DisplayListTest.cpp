@@ -0,0 +1,137 @@
+// Check that drawing recorded in a display list gives the same display
+// RAM and cursor as drawing sent directly.
+//
+// Build from the library folder:
+// g++ -std=gnu++11 -Iextras/host -Isrc extras/host/DisplayListTest.cpp
+//     src/SSD1306UTF8.cpp
+#include <stdlib.h>
+
+#include "RamDisplay.h"
+
+static int failures = 0;
+static uint8_t list[4096];
+
+static void none(SSD1306UTF8*) {}
+
+// Draw with setup() on two displays, then with draw(), on the second
+// display recorded in a list of size bytes.
+template <class Setup, class Draw>
+static bool check(const char* name, Setup setup, Draw draw,
+                  size_t size = sizeof(list)) {
+  RamDisplay direct;
+  RamDisplay recorded;
+  RamDisplay* both[] = {&direct, &recorded};
+  for (RamDisplay* d : both) {
+    d->begin(&Adafruit128x64);
+    d->setFont(System5x7);
+    d->clear();
+    d->setCursor(0, 0);
+    d->print("old text on\nthe display\n\n\nbottom");
+    setup(d);
+  }
+  draw(&direct);
+  recorded.beginRecord(list, size);
+  draw(&recorded);
+  recorded.endRecord();
+  bool ok = !memcmp(direct.ram, recorded.ram, sizeof(direct.ram)) &&
+            direct.startLine == recorded.startLine &&
+            direct.col() == recorded.col() && direct.row() == recorded.row();
+  if (!ok) {
+    printf("FAIL %s\n", name);
+    failures++;
+  }
+  return ok;
+}
+
+static const uint8_t* const fonts[] = {System5x7, Arial14, HelloWorldUTF8,
+                                       Adafruit5x7};
+
+static void fuzz(SSD1306UTF8* d, unsigned seed) {
+  static const char* const text[] = {"Hello", "x", "12.5", "a b c",
+                                     "\xe4\xbd\xa0\xe5\xa5\xbd", "line\nnext"};
+  srand(seed);
+  for (int i = 0; i < 40; i++) {
+    switch (rand() % 8) {
+      case 0:
+        d->fill(rand() % 128, rand() % 128, rand() % 8, rand() % 8,
+                rand() % 256);
+        break;
+      case 1:
+      case 2:
+        d->print(text[rand() % 6]);
+        break;
+      case 3:
+        d->setCursor(rand() % 129, rand() % 8);
+        break;
+      case 4:
+        d->setFont(fonts[rand() % 4]);
+        break;
+      case 5:
+        d->setInvertMode(rand() % 2);
+        break;
+      case 6:
+        d->setMagFactor(1 + rand() % 2);
+        break;
+      case 7:
+        d->setScrollMode(rand() % 3);
+        break;
+    }
+  }
+}
+
+int main() {
+  // Text recorded with the cursor at the right edge is clipped.
+  check(
+      "edge cursor",
+      [](SSD1306UTF8* d) {
+        d->setCursor(121, 2);
+        d->print("Hello");
+      },
+      [](SSD1306UTF8* d) {
+        d->print("xx");
+        d->setCursor(119, 5);
+      });
+  // Drawing that is not recorded is sent in order with the list.
+  check("codepoint", none, [](SSD1306UTF8* d) {
+    d->setCursor(0, 2);
+    d->print("under");
+    d->setCursor(6, 2);
+    d->writeCodepoint('X');
+    const uint16_t utf16[] = {'a', 0X4F60, 'b'};
+    d->setFont(HelloWorldUTF8);
+    d->writeUtf16(utf16, 3);
+    d->print("c");
+  });
+  check("label", none, [](SSD1306UTF8* d) {
+    static uint8_t buf[256];
+    TextLabel label;
+    d->setFont(Arial14);
+    d->renderLabel(&label, buf, sizeof(buf), "Label");
+    d->clear(0, 127, 4, 5);
+    d->setCursor(10, 4);
+    d->drawLabel(&label);
+    d->setCursor(20, 4);
+    d->print("ov");
+    d->ssd1306WriteRam(0XFF);
+  });
+  // A newline that scrolls is applied once.
+  for (uint8_t mode : {SCROLL_MODE_APP, SCROLL_MODE_AUTO}) {
+    check("scroll", none, [mode](SSD1306UTF8* d) {
+      d->setScrollMode(mode);
+      d->setCursor(0, 6);
+      d->println("one");
+      d->println("two");
+      d->print("three\nfour");
+      d->setCursor(30, 7);
+      d->print("x");
+    });
+  }
+  for (unsigned seed = 1; seed <= 400; seed++) {
+    char name[24];
+    snprintf(name, sizeof(name), "fuzz seed %u", seed);
+    check(name, none, [seed](SSD1306UTF8* d) { fuzz(d, seed); });
+    check(name, none, [seed](SSD1306UTF8* d) { fuzz(d, seed); }, 300);
+  }
+  printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures != 0;
+}
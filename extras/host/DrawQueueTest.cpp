@@ -0,0 +1,96 @@
+// Post draw commands from one thread and drain them in another.  Check
+// that every command arrives once, in order and not torn.
+//
+// Build from the library folder:
+// g++ -std=gnu++11 -pthread -Iextras/host -Isrc extras/host/DrawQueueTest.cpp
+//     src/SSD1306UTF8.cpp
+#include <thread>
+
+#include "SSD1306UTF8DrawQueue.h"
+
+static const uint8_t* const fonts[] = {System5x7, Adafruit5x7};
+
+// Check each write() against the commands posted before it.
+class CheckDisplay : public SSD1306UTF8 {
+ public:
+  void begin() { init(&Adafruit128x64); }
+  size_t write(const uint8_t* buf, size_t n) {
+    char text[16];
+    snprintf(text, sizeof(text), "%07u", next);
+    bool fill = next % 100 == 0;
+    if (n != 7 || memcmp(buf, text, 7) || col() != next % 100 ||
+        row() != next % 8 || font() != fonts[next % 2] ||
+        (fill && lastData != fillValue(next))) {
+      if (errors < 5) {
+        ::printf("error at %u: '%.*s' col %u row %u\n", next, (int)n,
+                 (const char*)buf, col(), row());
+      }
+      errors++;
+    }
+    next++;
+    return n;
+  }
+  static uint8_t fillValue(unsigned i) { return i | 1; }
+  unsigned next = 0;
+  unsigned errors = 0;
+
+ protected:
+  void writeDisplay(uint8_t b, uint8_t mode) {
+    if (mode != SSD1306_MODE_CMD) {
+      lastData = b;
+    }
+  }
+
+ private:
+  uint8_t lastData = 0;
+};
+
+int main() {
+  const unsigned N = 200000;
+  DrawQueue queue(fonts, 2);
+  CheckDisplay oled;
+  oled.begin();
+  bool done = false;
+  unsigned long full = 0;
+
+  std::thread producer([&] {
+    char text[16];
+    for (unsigned i = 0; i < N; i++) {
+      snprintf(text, sizeof(text), "%07u", i);
+      while (!queue.postFont(i % 2)) {
+        full++;
+        std::this_thread::yield();
+      }
+      if (i % 100 == 0) {
+        uint8_t c = i % 128;
+        while (!queue.postFill(c, c, 0, 0, CheckDisplay::fillValue(i))) {
+          full++;
+          std::this_thread::yield();
+        }
+      }
+      while (!queue.postCursor(i % 100, i % 8)) {
+        full++;
+        std::this_thread::yield();
+      }
+      while (!queue.postText(text)) {
+        full++;
+        std::this_thread::yield();
+      }
+    }
+    __atomic_store_n(&done, true, __ATOMIC_RELEASE);
+  });
+  // Drain a varying number of commands per call.
+  while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE) || !queue.empty()) {
+    if (!queue.drain(&oled, 1 + oled.next % 5)) {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+
+  bool ok = oled.next == N && oled.errors == 0 &&
+            queue.dropped() == (full < 255 ? full : 255);
+  printf("commands %u, errors %u, queue full %lu times\n", oled.next,
+         oled.errors, full);
+  printf("%s\n", ok ? "PASSED" : "FAILED");
+  return !ok;
+}
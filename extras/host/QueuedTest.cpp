@@ -0,0 +1,57 @@
+// Check that a queued transport gives the same display RAM as direct
+// drawing, with and without a writeDisplayBuf() override.
+//
+// Build from the library folder:
+// g++ -std=gnu++11 -Iextras/host -Isrc extras/host/QueuedTest.cpp
+//     src/SSD1306UTF8.cpp
+#include "RamDisplay.h"
+#include "SSD1306UTF8Queued.h"
+
+// Transport with a bulk data path.
+class BufDisplay : public RamDisplay {
+ protected:
+  void writeDisplayBuf(const uint8_t* buf, uint8_t n) {
+    while (n--) {
+      RamDisplay::writeDisplay(*buf++, SSD1306_MODE_RAM_BUF);
+    }
+  }
+};
+
+static int failures = 0;
+
+static void draw(SSD1306UTF8* d) {
+  d->setFont(System5x7);
+  d->clear();
+  d->println("Queued transport");
+  d->setFont(Arial14);
+  d->print("12345.6789");
+  d->fill(0, 127, 6, 6, 0X55);
+  d->setCursor(10, 7);
+  d->setFont(System5x7);
+  d->print("bottom line of text");
+}
+
+template <class Queued>
+static void check(const char* name, uint16_t step) {
+  RamDisplay direct;
+  direct.begin(&Adafruit128x64);
+  draw(&direct);
+  Queued queued;
+  queued.begin(&Adafruit128x64);
+  draw(&queued);
+  while (queued.service(step)) {
+  }
+  if (memcmp(direct.ram, queued.ram, sizeof(direct.ram))) {
+    printf("FAIL %s\n", name);
+    failures++;
+  }
+}
+
+int main() {
+  check<SSD1306UTF8Queued<RamDisplay, 64>>("writeDisplay only", 7);
+  check<SSD1306UTF8Queued<RamDisplay, 256>>("writeDisplay only 256", 256);
+  check<SSD1306UTF8Queued<BufDisplay, 64>>("writeDisplayBuf", 7);
+  check<SSD1306UTF8Queued<BufDisplay, 256>>("writeDisplayBuf 256", 256);
+  printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures != 0;
+}
@@ -0,0 +1,47 @@
+// Display RAM model for host tests.
+#ifndef RamDisplay_h
+#define RamDisplay_h
+#include "SSD1306UTF8.h"
+
+// Page addressing model of the controller.
+class RamDisplay : public SSD1306UTF8 {
+ public:
+  void begin(const DevType* dev) {
+    memset(ram, 0XA5, sizeof(ram));
+    init(dev);
+  }
+  uint8_t ram[8][132];
+  uint8_t startLine = 0;
+
+ protected:
+  void writeDisplay(uint8_t b, uint8_t mode) {
+    if (mode != SSD1306_MODE_CMD) {
+      if (m_hcol < 132) {
+        ram[m_page][m_hcol] = b;
+      }
+      m_hcol++;
+    } else if (m_args) {
+      m_args--;
+    } else if (b < 0X10) {
+      m_hcol = (m_hcol & 0XF0) | b;
+    } else if (b < 0X20) {
+      m_hcol = (m_hcol & 0X0F) | (b & 0X0F) << 4;
+    } else if (0X40 <= b && b < 0X80) {
+      startLine = b & 0X3F;
+    } else if ((b & 0XF8) == 0XB0) {
+      m_page = b & 7;
+    } else if (b == 0X21 || b == 0X22) {
+      m_args = 2;
+    } else if (b == 0X20 || b == 0X81 || b == 0X8D || b == 0XA8 ||
+               b == 0XAD || b == 0XD3 || b == 0XD5 || b == 0XD9 ||
+               b == 0XDA || b == 0XDB) {
+      m_args = 1;
+    }
+  }
+
+ private:
+  uint8_t m_hcol = 0;
+  uint8_t m_page = 0;
+  uint8_t m_args = 0;
+};
+#endif  // RamDisplay_h
@@ -0,0 +1,102 @@
+/**
+ * @file SSD1306UTF8Thread.h
+ * @brief Host transport that sends from a worker thread.
+ */
+#ifndef SSD1306UTF8Thread_h
+#define SSD1306UTF8Thread_h
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "SSD1306UTF8Async.h"
+//------------------------------------------------------------------------------
+/**
+ * @class SSD1306UTF8Thread
+ * @brief Reference asynchronous transport for Linux and other hosts.
+ *
+ * A worker thread plays the part of a DMA controller.  It passes each
+ * transfer to a sink function, waits for the time the bytes would take
+ * on the bus and calls transferDone().
+ */
+class SSD1306UTF8Thread : public SSD1306UTF8Async {
+ public:
+  /** Receives the bytes of each transfer. */
+  typedef std::function<void(const uint8_t* buf, uint8_t n, uint8_t mode)>
+      Sink;
+
+  ~SSD1306UTF8Thread() { end(); }
+  /**
+   * @brief Start the worker and initialize the display controller.
+   *
+   * @param[in] dev A device initialization structure.
+   * @param[in] sink Function called by the worker for each transfer.
+   * @param[in] usPerByte Simulated bus time per byte in microseconds.
+   */
+  void begin(const DevType* dev, Sink sink, unsigned usPerByte = 0) {
+    m_sink = sink;
+    m_usPerByte = usPerByte;
+    m_stop = false;
+    m_worker = std::thread(&SSD1306UTF8Thread::run, this);
+    init(dev);
+  }
+  /** @brief Send the staged bytes and stop the worker. */
+  void end() {
+    if (!m_worker.joinable()) {
+      return;
+    }
+    wait();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_cv.notify_one();
+    m_worker.join();
+  }
+
+ protected:
+  void startTransfer(const uint8_t* buf, uint8_t n, uint8_t mode) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_buf = buf;
+      m_n = n;
+      m_mode = mode;
+      m_pending = true;
+    }
+    m_cv.notify_one();
+  }
+
+ private:
+  void run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+      m_cv.wait(lock, [this] { return m_pending || m_stop; });
+      if (!m_pending) {
+        return;
+      }
+      m_pending = false;
+      lock.unlock();
+      m_sink(m_buf, m_n, m_mode);
+      if (m_usPerByte) {
+        std::this_thread::sleep_for(
+            std::chrono::microseconds(m_usPerByte * m_n));
+      }
+      // May call startTransfer() for the next segment.
+      transferDone();
+      lock.lock();
+    }
+  }
+
+  Sink m_sink;
+  unsigned m_usPerByte = 0;
+  std::thread m_worker;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  const uint8_t* m_buf = nullptr;
+  uint8_t m_n = 0;
+  uint8_t m_mode = 0;
+  bool m_pending = false;
+  bool m_stop = false;
+};
+#endif  // SSD1306UTF8Thread_h
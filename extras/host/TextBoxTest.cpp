@@ -0,0 +1,74 @@
+// Check that printTextBox() clears every row of the box it does not draw.
+//
+// Build from the library folder:
+// g++ -std=gnu++11 -Iextras/host -Isrc extras/host/TextBoxTest.cpp
+//     src/SSD1306UTF8.cpp
+#include "RamDisplay.h"
+
+static int failures = 0;
+
+static void expect(const char* name, bool ok) {
+  if (!ok) {
+    printf("FAIL %s\n", name);
+    failures++;
+  }
+}
+
+// Print str in box on a display filled with 0XFF.
+static void draw(RamDisplay* d, const TextBox* box, const char* str) {
+  d->begin(&Adafruit128x64);
+  d->setFont(System5x7);
+  d->fill(0, 127, 0, 7, 0XFF);
+  d->printTextBox(box, str);
+}
+
+// True if rows r0 to r1 of box are blank.
+static bool blank(const RamDisplay* d, const TextBox* box, uint8_t r0,
+                  uint8_t r1) {
+  for (uint8_t r = r0; r <= r1; r++) {
+    for (uint8_t c = box->col; c < box->col + box->width; c++) {
+      if (d->ram[r][c]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main() {
+  static const char text[] =
+      "The quick brown fox jumps over the lazy dog again and again";
+  RamDisplay d;
+  TextBox box;
+  box.width = 60;
+  box.lineSpacing = 2;
+
+  // Lines are on rows 0, 3 and 6, the rows between and below are blank.
+  for (int e = 0; e < 2; e++) {
+    box.ellipsis = e;
+    draw(&d, &box, text);
+    const char* name = e ? "spacing with ellipsis" : "spacing";
+    expect(name, blank(&d, &box, 1, 2) && blank(&d, &box, 4, 5) &&
+                     blank(&d, &box, 7, 7));
+    expect(name, d.ram[7][60] == 0XFF);
+  }
+
+  // A cut text ends with an ellipsis.
+  box.ellipsis = true;
+  RamDisplay cut;
+  draw(&cut, &box, text);
+  RamDisplay full;
+  box.ellipsis = false;
+  draw(&full, &box, text);
+  expect("ellipsis drawn", memcmp(cut.ram[6], full.ram[6], 132) != 0);
+
+  // Blanks after the last line are not cut text.
+  static const char three[] = "one\ntwo\nthree";
+  box.ellipsis = true;
+  draw(&cut, &box, "one\ntwo\nthree  \n \n");
+  draw(&full, &box, three);
+  expect("trailing blanks", !memcmp(cut.ram, full.ram, sizeof(cut.ram)));
+
+  printf("%s\n", failures ? "FAILED" : "PASSED");
+  return failures != 0;
+}
@@ -26,6 +26,13 @@
  * DEALINGS IN THE SOFTWARE.
  */
 #include "SSD1306UTF8.h"
+// Display list modes, m_listMode is zero when not recording.
+/** fill() and write() are added to the list. */
+#define LIST_RECORD 1
+/** Run an operation for the cursor position, discard the output. */
+#define LIST_DRY 2
+/** Render an operation into the page image. */
+#define LIST_REPLAY 3
 //------------------------------------------------------------------------------
 uint8_t SSD1306UTF8::charWidth(uint8_t c) const {
   if (!m_font) {
@@ -43,37 +50,23 @@ uint8_t SSD1306UTF8::charWidth(uint8_t c) const {
   // Fixed width font.
   return m_magFactor * readFontByte(m_font + FONT_WIDTH);
 }
-const uint8_t SSD1306UTF8::charWidthUtf8() {
-  if (!m_font) {
+//------------------------------------------------------------------------------
+uint8_t SSD1306UTF8::charWidthUtf8(uint32_t cp) const {
+  // find the glyph
+  const uint8_t *p_glyph_md = m_font ? findUtf8Glyph(cp) : nullptr;
+  if (!p_glyph_md) {
     return 0;
   }
 
   const uint8_t *font_utf8 = m_font + readFontBytes16(m_font + FONT_UTF8_HEADER_POS);
   uint16_t fontUtf8Settings = readFontBytes16(font_utf8);
-  uint8_t fontUse24bitAddr = fontUtf8Settings & 0b1000;
   uint8_t fontUseExtensionPlanes =  fontUtf8Settings & 0b100;
-  uint8_t fontUsePadding = fontUtf8Settings & 0b10;
   uint8_t fontIsFixedWidth = fontUtf8Settings & 0b1;
-  uint8_t glyphMetaLen = (fontUseExtensionPlanes ? 3 : 2) + (fontIsFixedWidth ? 0 : 1) + (fontUse24bitAddr ? 3 : 2);
-  uint16_t utf8Cnt = readFontBytes16(font_utf8 + FONT_UTF8_CHAR_COUNT);
   
   if (fontIsFixedWidth) {
-    return readFontByte(font_utf8 + FONT_UTF8_GLYPH_WIDTH);
+    return m_magFactor * readFontByte(font_utf8 + FONT_UTF8_GLYPH_WIDTH);
   }
-
-  // phrase glyph to Unicode
-  uint32_t g = utf8BufferToUnicode();
-  
-  // find the glyph
-  for (size_t i = 0; i < utf8Cnt; i++)
-  {
-    uint32_t pg = fontUseExtensionPlanes ? readFontBytes24(font_utf8 + FONT_UTF8_GLYPH_TABLE + i * glyphMetaLen) : readFontBytes16(font_utf8 + FONT_UTF8_GLYPH_TABLE + i * glyphMetaLen);
-    if (pg == g)
-    {
-      return readFontByte(font_utf8 + FONT_UTF8_GLYPH_TABLE + i * glyphMetaLen + (fontUseExtensionPlanes ? 3 : 2));
-    }
-  }
-  return 0;
+  return m_magFactor * readFontByte(p_glyph_md + (fontUseExtensionPlanes ? 3 : 2));
 }
 //------------------------------------------------------------------------------
 void SSD1306UTF8::clear() {
@@ -97,6 +90,10 @@ void SSD1306UTF8::clearField(uint8_t col, uint8_t row, uint8_t n) {
 }
 //------------------------------------------------------------------------------
 void SSD1306UTF8::displayRemap(bool mode) {
+#if TRACK_BLANK_BLOCKS
+  // Columns are mapped to RAM in the other direction.
+  blankReset();
+#endif  // TRACK_BLANK_BLOCKS
   ssd1306WriteCmd(mode ? SSD1306_SEGREMAP : SSD1306_SEGREMAP | 1);
   ssd1306WriteCmd(mode ? SSD1306_COMSCANINC : SSD1306_COMSCANDEC);
 }
@@ -110,22 +107,91 @@ void SSD1306UTF8::fill() {
 }
 //------------------------------------------------------------------------------
 void SSD1306UTF8::fill(uint8_t c0, uint8_t c1, uint8_t r0, uint8_t r1, uint8_t filler) {
+  if (m_listMode == LIST_RECORD) {
+    ListOp* op = listAppend(0);
+    if (op) {
+      op->font = nullptr;
+      op->col = c0;
+      op->row = r0;
+      op->c1 = c1;
+      op->r1 = r1;
+      op->filler = filler;
+      op->top = r0 > m_clipR0 ? r0 : m_clipR0;
+      op->bottom = r1 < m_clipR1 ? r1 : m_clipR1;
+      m_listText = 0;
+      m_listMode = LIST_DRY;
+    } else {
+      // Too large for the list, send it now.
+      m_listMode = 0;
+    }
+    fill(c0, c1, r0, r1, filler);
+    m_listMode = LIST_RECORD;
+    return;
+  }
   // Cancel skip character pixels.
   m_skip = 0;
 
-  // Insure only rows on display will be filled.
-  if (r1 >= displayRows()) r1 = displayRows() - 1;
+  // Insure only rows and columns in the clip rectangle will be filled.
+  uint8_t fc0 = c0 < m_clipC0 ? m_clipC0 : c0;
+  uint8_t fc1 = c1 > m_clipC1 ? m_clipC1 : c1;
+  uint8_t fr0 = r0 < m_clipR0 ? m_clipR0 : r0;
+  uint8_t fr1 = r1 > m_clipR1 ? m_clipR1 : r1;
 
-  for (uint8_t r = r0; r <= r1; r++) {
-    setCursor(c0, r);
-    for (uint8_t c = c0; c <= c1; c++) {
+  if (fc0 <= fc1) {
+    for (uint8_t r = fr0; r <= fr1; r++) {
+#if TRACK_BLANK_BLOCKS
+      if ((filler ^ m_invertMask) == 0 && !m_listMode) {
+        // Only write runs of blocks not known to be blank.
+        uint16_t blank = m_blank[ramPage(r)];
+        uint8_t c = fc0;
+        while (c <= fc1) {
+          if (blank & blankBit(c)) {
+            c = (c | 7) + 1;
+            continue;
+          }
+          uint8_t e = c | 7;
+          while (e < fc1 && !(blank & blankBit(e + 1))) {
+            e += 8;
+          }
+          if (e > fc1) {
+            e = fc1;
+          }
+          setCursor(c, r);
+          ssd1306WriteRamRepeat(filler, e - c + 1);
+          c = e + 1;
+        }
+        blankSet(r, fc0, fc1);
+        continue;
+      }
+#endif  // TRACK_BLANK_BLOCKS
+      setCursor(fc0, r);
       // Insure clear() writes zero. result is (filler^m_invertMask).
-      ssd1306WriteRamBuf(filler);
+      ssd1306WriteRamRepeat(filler, fc1 - fc0 + 1);
     }
   }
   setCursor(c0, r0);
 }
 //------------------------------------------------------------------------------
+#if TRACK_BLANK_BLOCKS
+void SSD1306UTF8::blankClear(uint8_t row, uint8_t col, uint8_t n) {
+  uint8_t end = col + n - 1;
+  uint16_t mask = 0;
+  for (uint8_t c = col & ~7; c <= end && c < 128; c += 8) {
+    mask |= blankBit(c);
+  }
+  m_blank[ramPage(row)] &= ~mask;
+}
+//------------------------------------------------------------------------------
+void SSD1306UTF8::blankSet(uint8_t row, uint8_t c0, uint8_t c1) {
+  // Only blocks completely inside c0 - c1 are known to be blank.
+  uint16_t mask = 0;
+  for (uint8_t c = (c0 + 7) & ~7; c + 7 <= c1 && c < 128; c += 8) {
+    mask |= blankBit(c);
+  }
+  m_blank[ramPage(row)] |= mask;
+}
+#endif  // TRACK_BLANK_BLOCKS
+//------------------------------------------------------------------------------
 void SSD1306UTF8::fillToEOL() {
   fill(m_col, displayWidth() - 1, m_row, m_row + fontRows() - 1, 0xFF);
 }
@@ -134,6 +200,49 @@ size_t SSD1306UTF8::fieldWidth(uint8_t n) {
   return n * (fontWidth() + letterSpacing());
 }
 //------------------------------------------------------------------------------
+const uint8_t* SSD1306UTF8::findUtf8Glyph(uint32_t g) const {
+  if (!fontSupportsUtf8()) {
+    return nullptr;
+  }
+  const uint8_t *font_utf8 = m_font + readFontBytes16(m_font + FONT_UTF8_HEADER_POS);
+  uint16_t fontUtf8Settings = readFontBytes16(font_utf8);
+  uint8_t fontIsSorted = fontUtf8Settings & 0b10000;
+  uint8_t fontUse24bitAddr = fontUtf8Settings & 0b1000;
+  uint8_t fontUseExtensionPlanes = fontUtf8Settings & 0b100;
+  uint8_t fontIsFixedWidth = fontUtf8Settings & 0b1;
+  uint8_t glyphMetaLen = (fontUseExtensionPlanes ? 3 : 2) + (fontIsFixedWidth ? 0 : 1) + (fontUse24bitAddr ? 3 : 2);
+  uint16_t utf8Cnt = readFontBytes16(font_utf8 + FONT_UTF8_CHAR_COUNT);
+  const uint8_t *table = font_utf8 + FONT_UTF8_GLYPH_TABLE;
+
+  if (fontIsSorted) {
+    // binary search, glyph table is sorted by codepoint
+    uint16_t lo = 0;
+    uint16_t hi = utf8Cnt;
+    while (lo < hi) {
+      uint16_t mid = lo + (hi - lo) / 2;
+      const uint8_t *p = table + (size_t)mid * glyphMetaLen;
+      uint32_t pg = fontUseExtensionPlanes ? readFontBytes24(p) : readFontBytes16(p);
+      if (pg == g) {
+        return p;
+      }
+      if (pg < g) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return nullptr;
+  }
+  for (size_t i = 0; i < utf8Cnt; i++) {
+    const uint8_t *p = table + i * glyphMetaLen;
+    uint32_t pg = fontUseExtensionPlanes ? readFontBytes24(p) : readFontBytes16(p);
+    if (pg == g) {
+      return p;
+    }
+  }
+  return nullptr;
+}
+//------------------------------------------------------------------------------
 uint8_t SSD1306UTF8::fontCharCount() const {
   return m_font ? readFontByte(m_font + FONT_CHAR_COUNT) : 0;
 }
@@ -182,6 +291,10 @@ void SSD1306UTF8::init(const DevType* dev) {
   m_displayWidth = readFontByte(&dev->lcdWidth);
   m_displayHeight = readFontByte(&dev->lcdHeight);
   m_colOffset = readFontByte(&dev->colOffset);
+  resetClip();
+#if TRACK_BLANK_BLOCKS
+  blankReset();
+#endif  // TRACK_BLANK_BLOCKS
   for (uint8_t i = 0; i < size; i++) {
     ssd1306WriteCmd(readFontByte(table + i));
   }
@@ -194,13 +307,43 @@ void SSD1306UTF8::invertDisplay(bool invert) {
 //------------------------------------------------------------------------------
 void SSD1306UTF8::setCol(uint8_t col) {
   if (col < m_displayWidth) {
+    // The column is sent by syncAddress() before the next RAM byte.
     m_col = col;
-    col += m_colOffset;
-    ssd1306WriteCmd(SSD1306_SETLOWCOLUMN | (col & 0XF));
-    ssd1306WriteCmd(SSD1306_SETHIGHCOLUMN | (col >> 4));
+    if (!m_frameDepth) {
+      writeDisplayFlush();
+    }
   }
 }
 //------------------------------------------------------------------------------
+void SSD1306UTF8::syncAddress() {
+  uint8_t col = m_col + m_colOffset;
+  // The pointer may wrap after the last column, treat it as unknown.
+  bool known = m_hwCol < m_displayWidth + m_colOffset;
+  if (!known || ((m_hwCol ^ col) & 0XF)) {
+    writeDisplay(SSD1306_SETLOWCOLUMN | (col & 0XF), SSD1306_MODE_CMD);
+  }
+  if (!known || ((m_hwCol ^ col) & 0XF0)) {
+    writeDisplay(SSD1306_SETHIGHCOLUMN | (col >> 4), SSD1306_MODE_CMD);
+  }
+  m_hwCol = col;
+#if INCLUDE_SCROLLING
+  uint8_t page = (m_row + m_pageOffset) & 7;
+#else   // INCLUDE_SCROLLING
+  uint8_t page = m_row;
+#endif  // INCLUDE_SCROLLING
+  if (page != m_hwPage) {
+    writeDisplay(SSD1306_SETSTARTPAGE | page, SSD1306_MODE_CMD);
+    m_hwPage = page;
+  }
+}
+//------------------------------------------------------------------------------
+void SSD1306UTF8::setClip(uint8_t c0, uint8_t c1, uint8_t r0, uint8_t r1) {
+  m_clipC0 = c0;
+  m_clipC1 = c1 < m_displayWidth ? c1 : m_displayWidth - 1;
+  m_clipR0 = r0;
+  m_clipR1 = r1 < displayRows() ? r1 : displayRows() - 1;
+}
+//------------------------------------------------------------------------------
 void SSD1306UTF8::setContrast(uint8_t value) {
   ssd1306WriteCmd(SSD1306_SETCONTRAST);
   ssd1306WriteCmd(value);
@@ -211,6 +354,13 @@ void SSD1306UTF8::setCursor(uint8_t col, uint8_t row) {
   setRow(row);
 }
 //------------------------------------------------------------------------------
+void SSD1306UTF8::setCharsetMode(uint8_t mode) {
+  m_charsetMode = mode;
+  m_codepage = mode == CHARSET_MODE_CODEPAGE ||
+               (mode == CHARSET_MODE_AUTO && m_font && !fontSupportsUtf8());
+  m_utf8.reset();
+}
+//------------------------------------------------------------------------------
 void SSD1306UTF8::setFont(const uint8_t* font) {
   m_font = font;
   if (font && (fontSize() == 1 || fontSize() == 3)) {
@@ -218,16 +368,370 @@ void SSD1306UTF8::setFont(const uint8_t* font) {
   } else {
     m_letterSpacing = 1;
   }
+  setCharsetMode(m_charsetMode);
+}
+//------------------------------------------------------------------------------
+bool SSD1306UTF8::nextChar(const char* str, size_t len, size_t* i,
+                           Utf8Decoder* decoder, uint32_t* cp) const {
+  while (*i < len) {
+    uint8_t ch = str[(*i)++];
+    if (m_codepage || (ch < 0X80 && !decoder->pending())) {
+      *cp = ch;
+      return true;
+    }
+    bool pending = decoder->pending();
+    uint8_t state = decoder->decode(ch);
+    if (state == UTF8_ACCEPT) {
+      *cp = decoder->codepoint();
+      return true;
+    }
+    if (state == UTF8_REJECT) {
+      decoder->reset();
+      if (pending) {
+        // Read the byte again as the start of a new character.
+        (*i)--;
+      }
+      *cp = m_utf8Replacement;
+      return true;
+    }
+  }
+  return false;
+}
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::printField(uint8_t col, uint8_t row, uint8_t width,
+                               const char* str, uint8_t align) {
+  if (!m_font) {
+    return 0;
+  }
+  size_t len = strlen(str);
+  return writeField(col, row, width, str, len, measureText(str, len).width,
+                    align);
+}
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::writeField(uint8_t col, uint8_t row, uint8_t width,
+                               const char* str, size_t len, size_t textWidth,
+                               uint8_t align, const char* suffix) {
+  if (!width) {
+    return 0;
+  }
+  if (col + width > 256) {
+    width = 256 - col;
+  }
+  uint8_t pad = textWidth < width ? width - textWidth : 0;
+  uint8_t lead = align == FIELD_ALIGN_RIGHT    ? pad
+                 : align == FIELD_ALIGN_CENTER ? pad / 2
+                                               : 0;
+  uint8_t c1 = col + width - 1;
+  uint8_t r1 = row + fontRows() - 1;
+
+  // Clip to the field inside the current clip rectangle.
+  uint8_t saveC0 = m_clipC0;
+  uint8_t saveC1 = m_clipC1;
+  uint8_t saveR0 = m_clipR0;
+  uint8_t saveR1 = m_clipR1;
+  setClip(col > saveC0 ? col : saveC0, c1 < saveC1 ? c1 : saveC1,
+          row > saveR0 ? row : saveR0, r1 < saveR1 ? r1 : saveR1);
+
+  if (lead) {
+    fill(col, col + lead - 1, row, r1, 0);
+  }
+  setCursor(col + lead, row);
+  size_t n = write(reinterpret_cast<const uint8_t*>(str), len);
+  if (suffix) {
+    write(suffix);
+  }
+  uint8_t end = m_col;
+  if (end <= c1) {
+    fill(end, c1, row, r1, 0);
+  }
+  setClip(saveC0, saveC1, saveR0, saveR1);
+  return n;
+}
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::printTextBox(const TextBox* box, const char* str) {
+  if (!m_font) {
+    return 0;
+  }
+  // Font context is read once for the whole layout.
+  uint8_t first = readFontByte(m_font + FONT_FIRST_CHAR);
+  uint8_t count = readFontByte(m_font + FONT_CHAR_COUNT);
+  uint8_t s = letterSpacing();
+  uint8_t us = fontSupportsUtf8() ? utf8GlyphSpacing() : 0;
+  uint8_t ellipsisWidth = box->ellipsis ? 3 * advance('.', first, count, s, us)
+                                        : 0;
+  bool word = box->wrap == TEXT_WRAP_WORD;
+  uint8_t lineRows = fontRows();
+  uint8_t pitch = lineRows + box->lineSpacing;
+  uint16_t boxEnd = box->row + box->rows;
+  uint8_t c1 = box->col + box->width - 1;
+
+  size_t len = strlen(str);
+  size_t i = 0;
+  uint16_t row = box->row;
+  for (; row + lineRows <= boxEnd; row += pitch) {
+    // Find the end of the line, each glyph is measured once.
+    size_t lineEnd = len;
+    size_t lineNext = len;
+    size_t lineWidth = 0;
+    size_t brkEnd = 0;
+    size_t brkNext = 0;
+    size_t brkWidth = 0;
+    bool haveBrk = false;
+    bool inSpace = false;
+    size_t w = 0;
+    size_t j = i;
+    Utf8Decoder decoder;
+    uint32_t cp;
+    while (true) {
+      size_t at = j;
+      if (!nextChar(str, len, &j, &decoder, &cp)) {
+        lineEnd = at;
+        lineNext = j;
+        lineWidth = w;
+        break;
+      }
+      if (cp == '\n') {
+        lineEnd = at;
+        lineNext = j;
+        lineWidth = w;
+        break;
+      }
+      uint8_t adv = advance(cp, first, count, s, us);
+      if (w + adv > box->width && at > i) {
+        // Wrap.  The line has at least one glyph.
+        if (word && cp == ' ') {
+          lineEnd = inSpace ? brkEnd : at;
+          lineWidth = inSpace ? brkWidth : w;
+          lineNext = j;
+        } else if (word && haveBrk) {
+          lineEnd = brkEnd;
+          lineWidth = brkWidth;
+          lineNext = brkNext;
+        } else {
+          lineEnd = at;
+          lineWidth = w;
+          lineNext = at;
+        }
+        if (word) {
+          while (lineNext < len && str[lineNext] == ' ') {
+            lineNext++;
+          }
+        }
+        break;
+      }
+      if (cp == ' ') {
+        if (!inSpace) {
+          brkEnd = at;
+          brkWidth = w;
+        }
+        brkNext = j;
+        haveBrk = true;
+        inSpace = true;
+      } else {
+        inSpace = false;
+      }
+      w += adv;
+    }
+    if (word && inSpace && lineEnd > brkEnd && lineEnd <= brkNext) {
+      // Drop trailing blanks.
+      lineEnd = brkEnd;
+      lineWidth = brkWidth;
+    }
+    bool last = row + pitch + lineRows > boxEnd;
+    size_t rest = lineNext;
+    while (rest < len && (str[rest] == ' ' || str[rest] == '\n')) {
+      rest++;
+    }
+    if (last && rest < len && box->ellipsis) {
+      // Cut the line so the ellipsis fits.
+      size_t cut = i;
+      w = 0;
+      j = i;
+      decoder.reset();
+      while (nextChar(str, lineEnd, &j, &decoder, &cp)) {
+        uint8_t adv = advance(cp, first, count, s, us);
+        if (w + adv + ellipsisWidth > box->width) {
+          break;
+        }
+        w += adv;
+        cut = j;
+      }
+      writeField(box->col, row, box->width, str + i, cut - i,
+                 w + ellipsisWidth, box->align, "...");
+      i = cut;
+      row += lineRows;
+      break;
+    }
+    writeField(box->col, row, box->width, str + i, lineEnd - i, lineWidth,
+               box->align);
+    i = lineNext;
+    // Clear the blank rows between lines.
+    uint16_t gapEnd = row + pitch < boxEnd ? row + pitch : boxEnd;
+    if (row + lineRows < gapEnd) {
+      fill(box->col, c1, row + lineRows, gapEnd - 1, 0);
+    }
+  }
+  // Clear rows below the last line.
+  if (row < boxEnd) {
+    fill(box->col, c1, row, boxEnd - 1, 0);
+  }
+  return i;
+}
+//------------------------------------------------------------------------------
+void SSD1306UTF8::numericFieldInit(NumericField* field, uint8_t col,
+                                   uint8_t row, uint8_t cells,
+                                   uint8_t decimals) {
+  uint8_t w = 0;
+  for (char c = '0'; c <= '9'; c++) {
+    uint8_t cw = charWidth(c);
+    if (cw > w) {
+      w = cw;
+    }
+  }
+  field->col = col;
+  field->row = row;
+  field->cellWidth = w + letterSpacing();
+  field->cells = cells < NUMERIC_FIELD_DIM ? cells : NUMERIC_FIELD_DIM;
+  field->decimals = decimals;
+  field->invalidate();
+}
+//------------------------------------------------------------------------------
+uint8_t SSD1306UTF8::numericFieldPrint(NumericField* field, int32_t value) {
+  char buf[NUMERIC_FIELD_DIM];
+  uint8_t n = field->cells;
+  uint8_t decimals = field->decimals;
+  bool neg = value < 0;
+  uint32_t v = neg ? -static_cast<uint32_t>(value) : value;
+
+  // Format right to left, at least one digit before the decimal point.
+  uint8_t i = n;
+  uint8_t digits = 0;
+  bool point = false;
+  while (i && (v || digits <= decimals)) {
+    if (decimals && digits == decimals && !point) {
+      buf[--i] = '.';
+      point = true;
+    } else {
+      buf[--i] = '0' + v % 10;
+      v /= 10;
+      digits++;
+    }
+  }
+  bool overflow = v || digits <= decimals || (neg && !i);
+  if (neg && i) {
+    buf[--i] = '-';
+  }
+  while (i) {
+    buf[--i] = ' ';
+  }
+  if (overflow) {
+    memset(buf, '#', n);
+  }
+
+  // Redraw changed cells.
+  uint8_t changed = 0;
+  char str[2] = {0, 0};
+  for (i = 0; i < n; i++) {
+    if (buf[i] != field->last[i]) {
+      str[0] = buf[i];
+      printField(field->col + i * field->cellWidth, field->row,
+                 field->cellWidth, str, FIELD_ALIGN_CENTER);
+      field->last[i] = buf[i];
+      changed++;
+    }
+  }
+  return changed;
+}
+//------------------------------------------------------------------------------
+uint8_t SSD1306UTF8::advance(uint32_t cp, uint8_t first, uint8_t count,
+                             uint8_t s, uint8_t us) const {
+  uint8_t w;
+  if (cp > 127 && !m_codepage) {
+    w = charWidthUtf8(cp);
+    return w ? w + us : 0;
+  }
+  if (first <= cp && cp < (first + count)) {
+    w = charWidth(cp);
+  } else if (ENABLE_NONFONT_SPACE && cp == ' ') {
+    w = fontWidth();
+  } else {
+    return 0;
+  }
+  return w ? w + s : 0;
+}
+//------------------------------------------------------------------------------
+TextExtent SSD1306UTF8::measureText(const char* str, size_t len) const {
+  TextExtent ext;
+  if (!m_font) {
+    return ext;
+  }
+  // Font context is read once for the whole string.
+  uint8_t first = readFontByte(m_font + FONT_FIRST_CHAR);
+  uint8_t count = readFontByte(m_font + FONT_CHAR_COUNT);
+  uint8_t s = letterSpacing();
+  uint8_t us = fontSupportsUtf8() ? utf8GlyphSpacing() : 0;
+
+  Utf8Decoder decoder;
+  size_t i = 0;
+  uint32_t cp;
+  while (nextChar(str, len, &i, &decoder, &cp)) {
+    uint8_t w = advance(cp, first, count, s, us);
+    if (!w) continue;
+    ext.width += w;
+    ext.glyphs++;
+  }
+  return ext;
+}
+//------------------------------------------------------------------------------
+bool SSD1306UTF8::renderLabel(TextLabel* label, uint8_t* buf, size_t size,
+                              const char* str) {
+  if (!m_font) {
+    return false;
+  }
+  size_t len = strlen(str);
+  size_t width = measureText(str, len).width;
+  uint8_t rows = fontRows();
+  if (width > 255 || width * rows > size) {
+    return false;
+  }
+  label->data = buf;
+  label->width = width;
+  label->rows = rows;
+
+  AsciiFont f;
+  loadAsciiFont(&f);
+  Utf8Decoder decoder;
+  size_t i = 0;
+  uint32_t cp;
+  size_t x = 0;
+  while (nextChar(str, len, &i, &decoder, &cp)) {
+    GlyphInfo g;
+    bool found = cp > 127 && !m_codepage ? utf8Glyph(cp, &g)
+                                         : cp < 256 && asciiGlyph(f, cp, &g);
+    if (!found || !g.w) {
+      continue;
+    }
+    uint8_t cols = m_magFactor * g.w + g.spacing;
+    if (x + cols > width) {
+      break;
+    }
+    renderGlyph(g, buf + x, width);
+    x += cols;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+void SSD1306UTF8::drawLabel(const TextLabel* label) {
+  writeBitmap(label->data, label->width, label->rows);
 }
 //------------------------------------------------------------------------------
 void SSD1306UTF8::setRow(uint8_t row) {
   if (row < displayRows()) {
+    // The page is sent by syncAddress() before the next RAM byte.
     m_row = row;
-#if INCLUDE_SCROLLING
-    ssd1306WriteCmd(SSD1306_SETSTARTPAGE | ((m_row + m_pageOffset) & 7));
-#else   // INCLUDE_SCROLLING
-    ssd1306WriteCmd(SSD1306_SETSTARTPAGE | m_row);
-#endif  // INCLUDE_SCROLLING
+    if (!m_frameDepth) {
+      writeDisplayFlush();
+    }
   }
 }
 #if INCLUDE_SCROLLING
@@ -238,48 +742,650 @@ void SSD1306UTF8::setPageOffset(uint8_t page) {
 }
 //------------------------------------------------------------------------------
 void SSD1306UTF8::setStartLine(uint8_t line) {
-  m_startLine = line & 0X3F;
-  ssd1306WriteCmd(SSD1306_SETSTARTLINE | m_startLine);
+  line &= 0X3F;
+  if (m_startLineSent && line == m_startLine) {
+    return;
+  }
+  m_startLine = line;
+  writeDisplay(SSD1306_SETSTARTLINE | m_startLine, SSD1306_MODE_CMD);
+  m_startLineSent = true;
 }
 #endif  // INCLUDE_SCROLLING
 //------------------------------------------------------------------------------
 void SSD1306UTF8::ssd1306WriteRam(uint8_t c) {
-  if (m_col < m_displayWidth) {
-    writeDisplay(c ^ m_invertMask, SSD1306_MODE_RAM);
+  uint8_t lead;
+  if (clipColumns(1, &lead)) {
+    c ^= m_invertMask;
+    if (m_listMode && listCapture()) {
+      listStore(nullptr, c, 1);
+    } else {
+#if TRACK_BLANK_BLOCKS
+      if (c) blankClear(m_row, m_col, 1);
+#endif  // TRACK_BLANK_BLOCKS
+      syncAddress();
+      writeDisplay(c, SSD1306_MODE_RAM);
+      m_hwCol++;
+    }
     m_col++;
   }
 }
 //------------------------------------------------------------------------------
 void SSD1306UTF8::ssd1306WriteRamBuf(uint8_t c) {
+  uint8_t lead;
   if (m_skip) {
     m_skip--;
-  } else if (m_col < m_displayWidth) {
-    writeDisplay(c ^ m_invertMask, SSD1306_MODE_RAM_BUF);
+  } else if (clipColumns(1, &lead)) {
+    c ^= m_invertMask;
+    if (m_listMode && listCapture()) {
+      listStore(nullptr, c, 1);
+    } else {
+#if TRACK_BLANK_BLOCKS
+      if (c) blankClear(m_row, m_col, 1);
+#endif  // TRACK_BLANK_BLOCKS
+      syncAddress();
+      writeDisplay(c, SSD1306_MODE_RAM_BUF);
+      m_hwCol++;
+    }
     m_col++;
   }
 }
 //------------------------------------------------------------------------------
-GLCDFONTDECL(scaledNibble) = {0X00, 0X03, 0X0C, 0X0F, 0X30, 0X33, 0X3C, 0X3F,
-                              0XC0, 0XC3, 0XCC, 0XCF, 0XF0, 0XF3, 0XFC, 0XFF};
+void SSD1306UTF8::ssd1306WriteRamRepeat(uint8_t c, uint8_t n) {
+  uint8_t k = m_skip < n ? m_skip : n;
+  m_skip -= k;
+  n = clipColumns(n - k, &k);
+  if (n) {
+    c ^= m_invertMask;
+    if (m_listMode && listCapture()) {
+      listStore(nullptr, c, n);
+    } else {
+#if TRACK_BLANK_BLOCKS
+      if (c) blankClear(m_row, m_col, n);
+#endif  // TRACK_BLANK_BLOCKS
+      syncAddress();
+      writeDisplayRepeat(c, n);
+      m_hwCol += n;
+    }
+    m_col += n;
+  }
+}
 //------------------------------------------------------------------------------
-const size_t SSD1306UTF8::strWidth(const char* str) {
-  size_t sw = 0;
-  while (*str) {
-    if (*str > 127) {
-      // char in utf8 
-      if (readUtf8Data(*str) > 1) {
-        uint8_t gw = charWidthUtf8();
-        if (gw) sw += gw + utf8GlyphSpacing();
-      }
+void SSD1306UTF8::writeRamBurst(const uint8_t* buf, uint8_t n) {
+  uint8_t k = m_skip < n ? m_skip : n;
+  m_skip -= k;
+  buf += k;
+  n = clipColumns(n - k, &k);
+  buf += k;
+  if (n) {
+    if (m_listMode && listCapture()) {
+      listStore(buf, 0, n);
     } else {
-      uint8_t cw = charWidth(*str);
-      if (cw) sw += cw + letterSpacing();
+#if TRACK_BLANK_BLOCKS
+      blankClear(m_row, m_col, n);
+#endif  // TRACK_BLANK_BLOCKS
+      syncAddress();
+      writeDisplayBuf(buf, n);
+      m_hwCol += n;
+    }
+    m_col += n;
+  }
+}
+//------------------------------------------------------------------------------
+void SSD1306UTF8::advanceColumns(uint8_t n) {
+  uint8_t k = m_skip < n ? m_skip : n;
+  m_skip -= k;
+  n -= k;
+  if (m_col <= m_clipC1) {
+    uint8_t room = m_clipC1 + 1 - m_col;
+    m_col += n < room ? n : room;
+  }
+}
+//------------------------------------------------------------------------------
+uint8_t SSD1306UTF8::clipColumns(uint8_t n, uint8_t* lead) {
+  *lead = 0;
+  if (m_col > m_clipC1) {
+    // The cursor stops one column right of the clip rectangle.
+    return 0;
+  }
+  uint8_t room = m_clipC1 + 1 - m_col;
+  if (n > room) {
+    n = room;
+  }
+  if (!rowVisible(m_row)) {
+    m_col += n;
+    return 0;
+  }
+  if (m_col < m_clipC0) {
+    uint8_t k = m_clipC0 - m_col;
+    if (k > n) {
+      k = n;
+    }
+    m_col += k;
+    n -= k;
+    *lead = k;
+  }
+  return n;
+}
+//------------------------------------------------------------------------------
+bool SSD1306UTF8::beginRecord(uint8_t* buf, size_t size) {
+  size_t ops = m_displayWidth + (m_displayWidth + 7) / 8;
+  ops = (ops + alignof(ListOp) - 1) & ~(alignof(ListOp) - 1);
+  if (m_listMode || size < ops + sizeof(ListOp) + 1) {
+    return false;
+  }
+  m_listBuf = buf;
+  m_listSize = size;
+  m_listUsed = ops;
+  m_listText = 0;
+  m_listMode = LIST_RECORD;
+  return true;
+}
+//------------------------------------------------------------------------------
+void SSD1306UTF8::endRecord() {
+  if (m_listMode != LIST_RECORD) {
+    return;
+  }
+  listFlush();
+  m_listMode = 0;
+  m_listBuf = nullptr;
+}
+//------------------------------------------------------------------------------
+bool SSD1306UTF8::beginFrame(uint8_t* buf, size_t size, bool holdTicker) {
+  if (m_frameDepth++) {
+    return true;
+  }
+  m_frameStart = micros();
+  m_frameHoldTicker = holdTicker;
+  m_frameList = buf && beginRecord(buf, size);
+  return !buf || m_frameList;
+}
+//------------------------------------------------------------------------------
+void SSD1306UTF8::endFrame() {
+  if (!m_frameDepth || --m_frameDepth) {
+    return;
+  }
+  if (m_frameList) {
+    endRecord();
+    m_frameList = false;
+  }
+  m_frameHoldTicker = false;
+  writeDisplayFlush();
+  m_frameMicros = micros() - m_frameStart;
+}
+//------------------------------------------------------------------------------
+SSD1306UTF8::ListOp* SSD1306UTF8::listAppend(size_t n) {
+  size_t ops = m_displayWidth + (m_displayWidth + 7) / 8;
+  ops = (ops + alignof(ListOp) - 1) & ~(alignof(ListOp) - 1);
+  size_t at = (m_listUsed + alignof(ListOp) - 1) & ~(alignof(ListOp) - 1);
+  if (at + sizeof(ListOp) + n > m_listSize) {
+    listFlush();
+    at = ops;
+    if (at + sizeof(ListOp) + n > m_listSize) {
+      return nullptr;
+    }
+  }
+  ListOp* op = reinterpret_cast<ListOp*>(m_listBuf + at);
+  op->font = m_font;
+  op->len = 0;
+  op->col = m_col;
+  op->row = m_row;
+  op->magFactor = m_magFactor;
+  op->invertMask = m_invertMask;
+  op->letterSpacing = m_letterSpacing;
+  op->skip = m_skip;
+  op->codepage = m_codepage;
+  op->clipC0 = m_clipC0;
+  op->clipC1 = m_clipC1;
+  op->utf8 = m_utf8;
+  m_listUsed = at + sizeof(ListOp);
+  return op;
+}
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::listRecord(const uint8_t* buf, size_t n) {
+#if INCLUDE_SCROLLING
+  size_t rtn = 0;
+  const uint8_t* nl;
+  while (m_scrollMode != SCROLL_MODE_OFF &&
+         (nl = static_cast<const uint8_t*>(memchr(buf, '\n', n)))) {
+    size_t k = nl - buf;
+    size_t m = k ? listRecordText(buf, k) : 0;
+    rtn += m;
+    if (m < k) {
+      return rtn;
+    }
+    if (m_row + 2 * fontRows() > displayRows()) {
+      // The newline scrolls the RAM window, send the list and scroll now.
+      listFlush();
+      m_listMode = 0;
+      rtn += write('\n');
+      m_listMode = LIST_RECORD;
+    } else {
+      rtn += listRecordText(nl, 1);
+    }
+    buf = nl + 1;
+    n -= k + 1;
+  }
+  return rtn + listRecordText(buf, n);
+#else   // INCLUDE_SCROLLING
+  return listRecordText(buf, n);
+#endif  // INCLUDE_SCROLLING
+}
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::listRecordText(const uint8_t* buf, size_t n) {
+  ListOp* op = m_listText ? reinterpret_cast<ListOp*>(m_listBuf + m_listText)
+                          : nullptr;
+  uint8_t* end = op ? reinterpret_cast<uint8_t*>(op + 1) + op->len : nullptr;
+  // Continue the open text operation if nothing changed since.
+  if (!op || m_listBuf + m_listUsed != end || m_listUsed + n > m_listSize ||
+      op->len + n > 0XFFFF || op->font != m_font ||
+      op->magFactor != m_magFactor || op->invertMask != m_invertMask ||
+      op->letterSpacing != m_letterSpacing || op->codepage != m_codepage ||
+      op->clipC0 != m_clipC0 || op->clipC1 != m_clipC1 ||
+      op->top < m_clipR0 || op->bottom > m_clipR1 || m_skip ||
+      m_listEndCol != m_col || m_listEndRow != m_row) {
+    m_listText = 0;
+    op = n <= 0XFFFF ? listAppend(n) : nullptr;
+    if (!op) {
+      // Too large for the list, send it now.
+      listFlush();
+      m_listMode = 0;
+      setCursor(m_col, m_row);
+      n = write(buf, n);
+      m_listMode = LIST_RECORD;
+      return n;
+    }
+    op->top = m_row > m_clipR0 ? m_row : m_clipR0;
+    op->bottom = op->top;
+    m_listText = reinterpret_cast<uint8_t*>(op) - m_listBuf;
+  }
+  memcpy(reinterpret_cast<uint8_t*>(op + 1) + op->len, buf, n);
+  uint8_t row = m_row;
+  m_listMode = LIST_DRY;
+  n = write(buf, n);
+  m_listMode = LIST_RECORD;
+  op->len += n;
+  m_listUsed += n;
+
+  // Rows changed by the text.
+  if (m_row < row) {
+    op->top = m_clipR0;
+    op->bottom = m_clipR1;
+  } else {
+    uint8_t bottom = m_row + fontRows() - 1;
+    if (bottom > m_clipR1) {
+      bottom = m_clipR1;
+    }
+    if (bottom > op->bottom) {
+      op->bottom = bottom;
+    }
+  }
+  m_listEndCol = m_col;
+  m_listEndRow = m_row;
+  return n;
+}
+//------------------------------------------------------------------------------
+bool SSD1306UTF8::listCapture() {
+  if (m_listMode == LIST_RECORD) {
+    // Drawing that is not recorded, send the list first to keep the order.
+    listFlush();
+    return false;
+  }
+  return true;
+}//------------------------------------------------------------------------------
+void SSD1306UTF8::listStore(const uint8_t* buf, uint8_t c, uint8_t n) {
+  if (m_listMode != LIST_REPLAY) {
+    return;
+  }
+  uint8_t* page = m_listBuf;
+  uint8_t* changed = m_listBuf + m_displayWidth;
+#if TRACK_BLANK_BLOCKS
+  uint16_t blank = m_blank[ramPage(m_row)];
+#endif  // TRACK_BLANK_BLOCKS
+  for (uint8_t i = 0, col = m_col; i < n; i++, col++) {
+    page[col] = buf ? buf[i] : c;
+#if TRACK_BLANK_BLOCKS
+    // Zero in a blank block does not change the display.
+    if (!page[col] && (blank & blankBit(col))) {
+      continue;
+    }
+#endif  // TRACK_BLANK_BLOCKS
+    changed[col >> 3] |= 1 << (col & 7);
+  }
+}
+//------------------------------------------------------------------------------
+void SSD1306UTF8::listFlush() {
+  size_t ops = m_displayWidth + (m_displayWidth + 7) / 8;
+  ops = (ops + alignof(ListOp) - 1) & ~(alignof(ListOp) - 1);
+  if (m_listUsed == ops) {
+    return;
+  }
+  // Save the drawing state.
+  const uint8_t* font = m_font;
+  uint8_t col = m_col;
+  uint8_t row = m_row;
+  uint8_t magFactor = m_magFactor;
+  uint8_t invertMask = m_invertMask;
+  uint8_t letterSpacing = m_letterSpacing;
+  uint8_t skip = m_skip;
+  bool codepage = m_codepage;
+  uint8_t clipC0 = m_clipC0;
+  uint8_t clipC1 = m_clipC1;
+  uint8_t clipR0 = m_clipR0;
+  uint8_t clipR1 = m_clipR1;
+  Utf8Decoder utf8 = m_utf8;
+#if INCLUDE_SCROLLING
+  // Recorded newlines do not scroll, listRecord() sends those that do.
+  uint8_t scrollMode = m_scrollMode;
+  m_scrollMode = SCROLL_MODE_OFF;
+#endif  // INCLUDE_SCROLLING
+
+  uint8_t* page = m_listBuf;
+  uint8_t* changed = m_listBuf + m_displayWidth;
+  for (uint8_t r = 0; r < displayRows(); r++) {
+    // Render the operations that change row r in list order.
+    memset(changed, 0, (m_displayWidth + 7) / 8);
+    m_listMode = LIST_REPLAY;
+    size_t at = ops;
+    while (at < m_listUsed) {
+      ListOp* op = reinterpret_cast<ListOp*>(m_listBuf + at);
+      if (op->top <= r && r <= op->bottom) {
+        m_font = op->font;
+        m_magFactor = op->magFactor;
+        m_invertMask = op->invertMask;
+        m_letterSpacing = op->letterSpacing;
+        m_codepage = op->codepage;
+        m_utf8 = op->utf8;
+        m_clipC0 = op->clipC0;
+        m_clipC1 = op->clipC1;
+        m_clipR0 = r;
+        m_clipR1 = r;
+        if (op->font) {
+          // Not setCursor(), the recorded column may be off the right edge.
+          m_col = op->col;
+          m_row = op->row;
+          m_skip = op->skip;
+          write(reinterpret_cast<const uint8_t*>(op + 1), op->len);
+        } else {
+          fill(op->col, op->c1, op->row, op->r1, op->filler);
+        }
+      }
+      at += sizeof(ListOp) + (op->font ? op->len : 0);
+      at = (at + alignof(ListOp) - 1) & ~(alignof(ListOp) - 1);
+    }
+    m_listMode = 0;
+    // Send each run of changed columns in one burst.
+    uint8_t c = 0;
+    while (c < m_displayWidth) {
+      if (!(changed[c >> 3] & (1 << (c & 7)))) {
+        c++;
+        continue;
+      }
+      uint8_t c0 = c;
+      while (c < m_displayWidth && (changed[c >> 3] & (1 << (c & 7)))) {
+        c++;
+      }
+      setCursor(c0, r);
+#if TRACK_BLANK_BLOCKS
+      blankClear(r, c0, c - c0);
+#endif  // TRACK_BLANK_BLOCKS
+      syncAddress();
+      writeDisplayBuf(page + c0, c - c0);
+      m_hwCol += c - c0;
+    }
+  }
+  m_font = font;
+  m_col = col;
+  m_row = row;
+  m_magFactor = magFactor;
+  m_invertMask = invertMask;
+  m_letterSpacing = letterSpacing;
+  m_skip = skip;
+  m_codepage = codepage;
+  m_clipC0 = clipC0;
+  m_clipC1 = clipC1;
+  m_clipR0 = clipR0;
+  m_clipR1 = clipR1;
+  m_utf8 = utf8;
+#if INCLUDE_SCROLLING
+  m_scrollMode = scrollMode;
+#endif  // INCLUDE_SCROLLING
+  m_listUsed = ops;
+  m_listText = 0;
+  m_listMode = LIST_RECORD;
+}
+//------------------------------------------------------------------------------
+// Nibble expansion for magnification 2X, 3X and 4X.  Each entry is a big
+// endian word with every bit of the nibble repeated magFactor times.
+GLCDFONTDECL(magNibble) = {
+    // 2X
+    0X00, 0X00, 0X00, 0X03, 0X00, 0X0C, 0X00, 0X0F,
+    0X00, 0X30, 0X00, 0X33, 0X00, 0X3C, 0X00, 0X3F,
+    0X00, 0XC0, 0X00, 0XC3, 0X00, 0XCC, 0X00, 0XCF,
+    0X00, 0XF0, 0X00, 0XF3, 0X00, 0XFC, 0X00, 0XFF,
+    // 3X
+    0X00, 0X00, 0X00, 0X07, 0X00, 0X38, 0X00, 0X3F,
+    0X01, 0XC0, 0X01, 0XC7, 0X01, 0XF8, 0X01, 0XFF,
+    0X0E, 0X00, 0X0E, 0X07, 0X0E, 0X38, 0X0E, 0X3F,
+    0X0F, 0XC0, 0X0F, 0XC7, 0X0F, 0XF8, 0X0F, 0XFF,
+    // 4X
+    0X00, 0X00, 0X00, 0X0F, 0X00, 0XF0, 0X00, 0XFF,
+    0X0F, 0X00, 0X0F, 0X0F, 0X0F, 0XF0, 0X0F, 0XFF,
+    0XF0, 0X00, 0XF0, 0X0F, 0XF0, 0XF0, 0XF0, 0XFF,
+    0XFF, 0X00, 0XFF, 0X0F, 0XFF, 0XF0, 0XFF, 0XFF};
+//------------------------------------------------------------------------------
+// Expand the eight pixels of b to 8*magFactor pixels.
+static inline uint32_t magnify(uint8_t b, const uint8_t* table, uint8_t nb) {
+  return readFontBytes16(table + 2 * (b & 0XF)) |
+         (uint32_t)readFontBytes16(table + 2 * (b >> 4)) << nb;
+}
+//------------------------------------------------------------------------------
+void SSD1306UTF8::setMagFactor(uint8_t n) {
+  m_magFactor = n < 1 ? 1 : n > 4 ? 4 : n;
+}
+//------------------------------------------------------------------------------
+void SSD1306UTF8::writeGlyph(uint32_t cp, const GlyphInfo& g) {
+#if GLYPH_CACHE_SIZE
+  if (writeCachedGlyph(cp, g)) {
+    return;
+  }
+#else   // GLYPH_CACHE_SIZE
+  (void)cp;
+#endif  // GLYPH_CACHE_SIZE
+  const uint8_t* data = g.data;
+  uint8_t w = g.w;
+  uint8_t nr = g.nr;
+  uint8_t shift = g.shift;
+  uint8_t spacing = g.spacing;
+  uint8_t mag = m_magFactor;
+  // Expansion table and nibble width for this magnification.
+  const uint8_t* table = mag > 1 ? magNibble + 32 * (mag - 2) : magNibble;
+  uint8_t nb = 4 * mag;
+
+  uint8_t scol = m_col;
+  uint8_t srow = m_row;
+  uint8_t skip = m_skip;
+  bool drawn = false;
+  for (uint8_t r = 0; r < nr; r++) {
+    // The last row of variable width glyphs is stored bottom aligned.
+    uint8_t rs = (r + 1) == nr ? shift : 0;
+    for (uint8_t m = 0; m < mag; m++) {
+      uint8_t row = srow + r * mag + m;
+      if (!rowVisible(row)) {
+        continue;
+      }
+      skipColumns(skip);
+      if (r || m) {
+        setCursor(scol, row);
+      }
+      if (!data) {
+        // non-font space.
+        for (uint8_t c = 0; c < w; c++) {
+          ssd1306WriteRamRepeat(0, mag);
+        }
+      } else if (mag == 1) {
+        for (uint8_t c = 0; c < w; c++) {
+          ssd1306WriteRamBuf(readFontByte(data + c + r * w) >> rs);
+        }
+      } else {
+        for (uint8_t c = 0; c < w; c++) {
+          uint8_t b = readFontByte(data + c + r * w) >> rs;
+          ssd1306WriteRamRepeat(magnify(b, table, nb) >> (8 * m), mag);
+        }
+      }
+      ssd1306WriteRamRepeat(0, spacing);
+      drawn = true;
     }
-    str++;
   }
-  return sw;
+  if (!drawn) {
+    advanceColumns(mag * w + spacing);
+  }
+  setRow(srow);
 }
 //------------------------------------------------------------------------------
+void SSD1306UTF8::renderGlyph(const GlyphInfo& g, uint8_t* out,
+                              uint8_t stride) const {
+  uint8_t mag = m_magFactor;
+  const uint8_t* table = mag > 1 ? magNibble + 32 * (mag - 2) : magNibble;
+  uint8_t nb = 4 * mag;
+  uint8_t cols = mag * g.w + g.spacing;
+  for (uint8_t r = 0; r < g.nr; r++) {
+    uint8_t rs = (r + 1) == g.nr ? g.shift : 0;
+    for (uint8_t m = 0; m < mag; m++, out += stride - cols) {
+      for (uint8_t c = 0; c < g.w; c++) {
+        uint8_t b = g.data ? readFontByte(g.data + c + r * g.w) >> rs : 0;
+        if (mag > 1) {
+          b = magnify(b, table, nb) >> (8 * m);
+        }
+        memset(out, b ^ m_invertMask, mag);
+        out += mag;
+      }
+      memset(out, m_invertMask, g.spacing);
+      out += g.spacing;
+    }
+  }
+}
+//------------------------------------------------------------------------------
+void SSD1306UTF8::writeBitmap(const uint8_t* data, uint8_t width,
+                              uint8_t rows) {
+  uint8_t scol = m_col;
+  uint8_t srow = m_row;
+  uint8_t skip = m_skip;
+  bool drawn = false;
+  for (uint8_t r = 0; r < rows; r++, data += width) {
+    if (!rowVisible(srow + r)) {
+      continue;
+    }
+    skipColumns(skip);
+    if (r) {
+      setCursor(scol, srow + r);
+    }
+    writeRamBurst(data, width);
+    drawn = true;
+  }
+  if (!drawn) {
+    advanceColumns(width);
+  }
+  setRow(srow);
+}
+//------------------------------------------------------------------------------
+void SSD1306UTF8::writeFlashBitmap(const uint8_t* data, uint8_t width,
+                                   uint8_t rows) {
+#ifndef __AVR__
+  if (!m_invertMask) {
+    writeBitmap(data, width, rows);
+    return;
+  }
+#endif  // __AVR__
+  uint8_t scol = m_col;
+  uint8_t srow = m_row;
+  uint8_t skip = m_skip;
+  bool drawn = false;
+  for (uint8_t r = 0; r < rows; r++, data += width) {
+    if (!rowVisible(srow + r)) {
+      continue;
+    }
+    skipColumns(skip);
+    if (r) {
+      setCursor(scol, srow + r);
+    }
+    for (uint8_t c = 0; c < width; c++) {
+      ssd1306WriteRamBuf(readFontByte(data + c));
+    }
+    drawn = true;
+  }
+  if (!drawn) {
+    advanceColumns(width);
+  }
+  setRow(srow);
+}
+#if __cplusplus >= 201402L
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::writeResolved(const uint8_t* font, const uint8_t* glyphs,
+                                  size_t n) {
+  // The glyph cache is keyed by m_font and m_codepage, cp is Unicode.
+  const uint8_t* save = m_font;
+  bool codepage = m_codepage;
+  m_font = font;
+  m_codepage = false;
+  GlyphInfo g;
+  g.nr = (readFontByte(font + FONT_HEIGHT) + 7) / 8;
+  for (size_t i = 0; i < n; i++, glyphs += RESOLVED_GLYPH_SIZE) {
+    uint8_t flags = readFontByte(glyphs + RESOLVED_GLYPH_FLAGS);
+    g.data = flags & RESOLVED_GLYPH_BLANK
+                 ? nullptr
+                 : font + readFontBytes24(glyphs + RESOLVED_GLYPH_DATA);
+    g.w = readFontByte(glyphs + RESOLVED_GLYPH_WIDTH);
+    g.shift = flags & 7;
+    g.spacing = flags & RESOLVED_GLYPH_SPACING ? m_magFactor : 0;
+    writeGlyph(readFontBytes24(glyphs + RESOLVED_GLYPH_CP), g);
+  }
+  m_font = save;
+  m_codepage = codepage;
+  return n;
+}
+#endif  // __cplusplus >= 201402L
+#if GLYPH_CACHE_SIZE
+//------------------------------------------------------------------------------
+bool SSD1306UTF8::writeCachedGlyph(uint32_t cp, const GlyphInfo& g) {
+  uint8_t mag = m_magFactor;
+  uint16_t cols = mag * g.w + g.spacing;
+  uint8_t pages = mag * g.nr;
+  if (cols * pages > GLYPH_CACHE_BYTES) {
+    return false;
+  }
+  GlyphCacheEntry* e = nullptr;
+  GlyphCacheEntry* lru = m_glyphCache;
+  for (uint8_t i = 0; i < GLYPH_CACHE_SIZE; i++) {
+    GlyphCacheEntry* p = &m_glyphCache[i];
+    if (p->font == m_font && p->cp == cp && p->mag == mag &&
+        p->invert == m_invertMask && p->spacing == g.spacing &&
+        p->codepage == m_codepage) {
+      e = p;
+      break;
+    }
+    if (p->used < lru->used) {
+      lru = p;
+    }
+  }
+  if (!e) {
+    // Render the glyph into the least recently used entry.
+    e = lru;
+    e->font = m_font;
+    e->cp = cp;
+    e->codepage = m_codepage;
+    e->mag = mag;
+    e->invert = m_invertMask;
+    e->spacing = g.spacing;
+    e->cols = cols;
+    e->pages = pages;
+    renderGlyph(g, e->data, cols);
+  }
+  e->used = ++m_glyphCacheTick;
+  writeBitmap(e->data, e->cols, e->pages);
+  return true;
+}
+#endif  // GLYPH_CACHE_SIZE
+//------------------------------------------------------------------------------
 void SSD1306UTF8::tickerInit(TickerState* state, const uint8_t* font,
                               uint8_t row, bool mag2X, uint8_t bgnCol,
                               uint8_t endCol) {
@@ -313,6 +1419,9 @@ int8_t SSD1306UTF8::tickerTick(TickerState* state) {
   if (!state->nQueue) {
     return 0;
   }
+  if (m_frameDepth && m_frameHoldTicker) {
+    return state->nQueue;
+  }
   setFont(state->font);
   m_magFactor = state->mag2X ? 2 : 1;
   if (state->init) {
@@ -322,9 +1431,13 @@ int8_t SSD1306UTF8::tickerTick(TickerState* state) {
     state->skip = 0;
     state->init = false;
   }
-  // Adjust display width to truncate pixels after endCol.  Find better way?
-  uint8_t save = m_displayWidth;
-  m_displayWidth = state->endCol + 1;
+  // Clip pixels after endCol.
+  uint8_t c0 = m_clipC0;
+  uint8_t c1 = m_clipC1;
+  uint8_t r0 = m_clipR0;
+  uint8_t r1 = m_clipR1;
+  setClip(state->bgnCol, state->endCol, state->row,
+          state->row + fontRows() - 1);
 
   // Skip pixels before bgnCol.
   skipColumns(state->skip);
@@ -341,8 +1454,8 @@ int8_t SSD1306UTF8::tickerTick(TickerState* state) {
   if (m_col <= state->endCol) {
     clear(m_col, m_col, state->row, state->row + fontRows() - 1);
   }
-  // Restore display width.
-  m_displayWidth = save;
+  // Restore clip rectangle.
+  setClip(c0, c1, r0, r1);
 
   if (state->nQueue == 1 && *state->queue[0] == 0) {
     state->nQueue = 0;
@@ -366,169 +1479,423 @@ int8_t SSD1306UTF8::tickerTick(TickerState* state) {
   return state->nQueue;
 }
 //------------------------------------------------------------------------------
-uint32_t SSD1306UTF8::utf8BufferToUnicode() {
-  uint32_t g = 0;
-  uint8_t b = 0;
-  if (m_utf8Buffer[0] >= 0xF0) {
-    g = m_utf8Buffer[0] & 0b00000111;
-    b = 4;
-  } else if (m_utf8Buffer[0] >= 0xE0) {
-    g = m_utf8Buffer[0] & 0b00001111;
-    b = 3;
-  } else if (m_utf8Buffer[0] >= 0xC0) {
-    g = m_utf8Buffer[0] & 0b00011111;
-    b = 2;
-  }
-  for (uint8_t i = 1; i < b; i++)
-  {
-    g = g << 6;
-    g |= (m_utf8Buffer[i] & 0b00111111);
+const uint8_t SSD1306UTF8::utf8GlyphSpacing() const {
+  const uint8_t *font_utf8 = m_font + readFontBytes16(m_font + FONT_UTF8_HEADER_POS);
+  uint16_t fontUtf8Settings = readFontBytes16(font_utf8);
+  return (fontUtf8Settings & 0b10) ? m_magFactor : 0;
+}
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::writeCodepoint(uint32_t cp) {
+  if (!m_font) {
+    return 0;
   }
-  return g;
+  return cp > 127 ? writeUtf8Glyph(cp) : writeAscii(cp);
 }
 //------------------------------------------------------------------------------
-const uint8_t SSD1306UTF8::utf8GlyphSpacing() {
-  const uint8_t *font_utf8 = m_font + readFontBytes16(m_font + FONT_UTF8_HEADER_POS);
-  uint16_t fontUtf8Settings = readFontBytes16(font_utf8);
-  return fontUtf8Settings & 0b10;
+size_t SSD1306UTF8::writeUtf16(const uint16_t* str, size_t len) {
+  size_t n = 0;
+  while (n < len) {
+    uint32_t cp = str[n];
+    size_t units = 1;
+    if (0XD800 <= cp && cp <= 0XDFFF) {
+      if (cp < 0XDC00 && n + 1 < len && 0XDC00 <= str[n + 1] &&
+          str[n + 1] <= 0XDFFF) {
+        // Surrogate pair.
+        cp = 0X10000 + ((cp - 0XD800) << 10) + (str[n + 1] - 0XDC00);
+        units = 2;
+      } else {
+        // Unpaired surrogate.
+        cp = m_utf8Replacement;
+      }
+    }
+    if (cp && !writeCodepoint(cp)) {
+      break;
+    }
+    n += units;
+  }
+  return n;
 }
 //------------------------------------------------------------------------------
-uint8_t SSD1306UTF8::writeUtf8Glyph() {
-  //font data
-  const uint8_t *font_utf8 = m_font + readFontBytes16(m_font + FONT_UTF8_HEADER_POS);
-  uint16_t fontUtf8Settings = readFontBytes16(font_utf8);
-  uint8_t fontUse24bitAddr = fontUtf8Settings & 0b1000;
-  uint8_t fontUseExtensionPlanes = fontUtf8Settings & 0b100;
-  uint8_t fontUsePadding = fontUtf8Settings & 0b10;
-  uint8_t fontIsFixedWidth = fontUtf8Settings & 0b1;
-  uint8_t glyphMetaLen = (fontUseExtensionPlanes ? 3 : 2) + (fontIsFixedWidth ? 0 : 1) + (fontUse24bitAddr ? 3 : 2);
-  uint16_t utf8Cnt = readFontBytes16(font_utf8 + FONT_UTF8_CHAR_COUNT);
-
-  // phrase glyph to Unicode
-  uint32_t g = utf8BufferToUnicode();
-
-  // find the glyph
-  const uint8_t *p_glyph_md = font_utf8;
-  uint8_t w = 0;
-  uint8_t h = readFontByte(m_font + FONT_HEIGHT);
-  uint8_t nr = (h + 7) / 8;
-  for (size_t i = 0; i < utf8Cnt; i++)
-  {
-    uint32_t pg = fontUseExtensionPlanes ? readFontBytes24(font_utf8 + FONT_UTF8_GLYPH_TABLE + i * glyphMetaLen) : readFontBytes16(font_utf8 + FONT_UTF8_GLYPH_TABLE + i * glyphMetaLen);
-    if (pg == g)
-    {
-      p_glyph_md += FONT_UTF8_GLYPH_TABLE + i * glyphMetaLen;
-      w = fontIsFixedWidth ? readFontByte(font_utf8 + FONT_UTF8_GLYPH_WIDTH) : readFontByte(p_glyph_md + (fontUseExtensionPlanes ? 3 : 2));
+size_t SSD1306UTF8::writeUtf32(const uint32_t* str, size_t len) {
+  size_t n = 0;
+  for (; n < len; n++) {
+    uint32_t cp = str[n];
+    if (cp > 0X10FFFF || (0XD800 <= cp && cp <= 0XDFFF)) {
+      cp = m_utf8Replacement;
+    }
+    if (cp && !writeCodepoint(cp)) {
       break;
     }
   }
-  if (p_glyph_md == font_utf8) return 0;
-
-  const uint8_t *p_glyph_d = m_font + (fontUse24bitAddr ? readFontBytes24(p_glyph_md + glyphMetaLen - 3) : readFontBytes16(p_glyph_md + glyphMetaLen - 2));
-
-  uint8_t s = fontUsePadding ? 1 : 0;
-  uint8_t thieleShift = 0;
-  if (!fontIsFixedWidth)
-  {
-    if (h & 7) {
-      thieleShift = 8 - (h & 7);
+  return n;
+}
+//------------------------------------------------------------------------------
+// Format v right to left ending at end, at least minDigits digits.
+static char* formatUInt(char* end, unsigned long v, uint8_t base, bool upper,
+                        uint8_t minDigits) {
+  char* p = end;
+  do {
+    uint8_t d = v % base;
+    v /= base;
+    *--p = d < 10 ? '0' + d : (upper ? 'A' : 'a') + d - 10;
+  } while (v || (end - p) < minDigits);
+  return p;
+}
+//------------------------------------------------------------------------------
+#if PRINTF_FLOAT
+// Format x >= 0 right to left ending at end with prec decimals.
+static char* formatDouble(char* end, double x, uint8_t prec) {
+  if (prec > 9) {
+    prec = 9;
+  }
+  // Round like Print::printFloat().
+  double rounding = 0.5;
+  for (uint8_t i = 0; i < prec; i++) {
+    rounding /= 10.0;
+  }
+  x += rounding;
+  uint32_t ip = x > 4294967295.0 ? 4294967295UL : x;
+  double frac = x - ip;
+  char* p = end - prec;
+  for (uint8_t i = 0; i < prec; i++) {
+    frac *= 10.0;
+    uint8_t d = frac;
+    if (d > 9) {
+      d = 9;
     }
+    p[i] = '0' + d;
+    frac -= d;
   }
-  
-  uint8_t scol = m_col;
-  uint8_t srow = m_row;
-  uint8_t skip = m_skip;
-  for (uint8_t r = 0; r < nr; r++) {
-    for (uint8_t m = 0; m < m_magFactor; m++) {
-      skipColumns(skip);
-      if (r || m) {
-        setCursor(scol, m_row + 1);
+  if (prec) {
+    *--p = '.';
+  }
+  return formatUInt(p, ip, 10, false, 1);
+}
+#endif  // PRINTF_FLOAT
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::writePad(char c, uint8_t n) {
+  char chunk[8];
+  memset(chunk, c, sizeof(chunk));
+  size_t r = 0;
+  while (n) {
+    uint8_t k = n < sizeof(chunk) ? n : sizeof(chunk);
+    r += write(reinterpret_cast<const uint8_t*>(chunk), k);
+    n -= k;
+  }
+  return r;
+}
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::writePadded(const char* str, size_t len, char sign,
+                                uint8_t width, char pad, bool left) {
+  size_t w = len + (sign ? 1 : 0);
+  uint8_t fill = width > w ? width - w : 0;
+  size_t n = 0;
+  if (!left && pad == ' ') {
+    n += writePad(' ', fill);
+  }
+  if (sign) {
+    n += write(sign);
+  }
+  if (!left && pad != ' ') {
+    n += writePad(pad, fill);
+  }
+  n += write(reinterpret_cast<const uint8_t*>(str), len);
+  if (left) {
+    n += writePad(' ', fill);
+  }
+  return n;
+}
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::printInt(int32_t value, uint8_t width, char pad) {
+  char buf[10];
+  char* end = buf + sizeof(buf);
+  uint32_t v = value < 0 ? -static_cast<uint32_t>(value) : value;
+  char* p = formatUInt(end, v, 10, false, 1);
+  return writePadded(p, end - p, value < 0 ? '-' : 0, width, pad, false);
+}
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::printFixed(int32_t value, uint8_t decimals, uint8_t width,
+                               char pad) {
+  char buf[12];
+  char* end = buf + sizeof(buf);
+  if (decimals > 9) {
+    decimals = 9;
+  }
+  uint32_t v = value < 0 ? -static_cast<uint32_t>(value) : value;
+  char* p = formatUInt(end, v, 10, false, decimals + 1);
+  if (decimals) {
+    // Move the integer part left to make room for the point.
+    memmove(p - 1, p, end - p - decimals);
+    p--;
+    end[-decimals - 1] = '.';
+  }
+  return writePadded(p, end - p, value < 0 ? '-' : 0, width, pad, false);
+}
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::printf(const char* format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  size_t n = 0;
+  const char* run = format;
+  while (*format) {
+    if (*format != '%') {
+      format++;
+      continue;
+    }
+    // Write the text before the conversion as one run.
+    n += write(reinterpret_cast<const uint8_t*>(run), format - run);
+    const char* spec = format++;
+    bool left = false;
+    char pad = ' ';
+    char plus = 0;
+    for (;; format++) {
+      if (*format == '-') {
+        left = true;
+      } else if (*format == '0') {
+        pad = '0';
+      } else if (*format == '+') {
+        plus = '+';
+      } else if (*format == ' ') {
+        if (!plus) plus = ' ';
+      } else {
+        break;
+      }
+    }
+    uint8_t width = 0;
+    while ('0' <= *format && *format <= '9') {
+      width = 10 * width + *format++ - '0';
+    }
+    int8_t prec = -1;
+    if (*format == '.') {
+      format++;
+      prec = 0;
+      while ('0' <= *format && *format <= '9') {
+        prec = 10 * prec + *format++ - '0';
+      }
+    }
+    bool isLong = false;
+    while (*format == 'l' || *format == 'h') {
+      isLong |= *format++ == 'l';
+    }
+    char buf[24];
+    char* end = buf + sizeof(buf);
+    char* p = end;
+    char sign = 0;
+    char conv = *format;
+    if (conv) {
+      format++;
+    }
+    switch (conv) {
+      case 'd':
+      case 'i': {
+        long v = isLong ? va_arg(ap, long) : va_arg(ap, int);
+        sign = v < 0 ? '-' : plus;
+        p = formatUInt(end, v < 0 ? -static_cast<unsigned long>(v) : v, 10,
+                       false, 1);
+        break;
+      }
+      case 'u':
+      case 'x':
+      case 'X': {
+        unsigned long v =
+            isLong ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int);
+        p = formatUInt(end, v, conv == 'u' ? 10 : 16, conv == 'X', 1);
+        break;
       }
-      for (uint8_t c = 0; c < w; c++) {
-        uint8_t b = readFontByte(p_glyph_d + c + r * w);
-        if (thieleShift && (r + 1) == nr) {
-          b >>= thieleShift;
+      case 'c':
+        *--p = va_arg(ap, int);
+        pad = ' ';
+        break;
+      case 's': {
+        const char* str = va_arg(ap, const char*);
+        if (!str) {
+          str = "(null)";
         }
-        if (m_magFactor == 2) {
-          b = m ? b >> 4 : b & 0XF;
-          b = readFontByte(scaledNibble + b);
-          ssd1306WriteRamBuf(b);
+        size_t len = strlen(str);
+        if (prec >= 0 && static_cast<size_t>(prec) < len) {
+          len = prec;
         }
-        ssd1306WriteRamBuf(b);
+        n += writePadded(str, len, 0, width, ' ', left);
+        run = format;
+        continue;
       }
-      for (uint8_t i = 0; i < s; i++) {
-        ssd1306WriteRamBuf(0);
+      case 'f': {
+        double x = va_arg(ap, double);
+#if PRINTF_FLOAT
+        if (x != x || x - x != 0 || x > 4294967040.0 || x < -4294967040.0) {
+          // Same text as Print::printFloat(), zero padding does not apply.
+          const char* text = x != x ? "nan" : x - x != 0 ? "inf" : "ovf";
+          sign = x != x || x - x == 0 ? 0 : x < 0 ? '-' : plus;
+          p -= 3;
+          memcpy(p, text, 3);
+          pad = ' ';
+          break;
+        }
+        sign = x < 0 ? '-' : plus;
+        p = formatDouble(end, x < 0 ? -x : x, prec < 0 ? 6 : prec);
+#else   // PRINTF_FLOAT
+        (void)x;
+        *--p = '?';
+        pad = ' ';
+#endif  // PRINTF_FLOAT
+        break;
       }
+      case '%':
+        *--p = '%';
+        width = 0;
+        break;
+      default:
+        // Unknown conversion, write it as text.
+        n += write(reinterpret_cast<const uint8_t*>(spec), format - spec);
+        run = format;
+        continue;
     }
+    n += writePadded(p, end - p, sign, width, pad, left);
+    run = format;
   }
-  setRow(srow);
-  return 1;
+  n += write(reinterpret_cast<const uint8_t*>(run), format - run);
+  va_end(ap);
+  return n;
 }
 //------------------------------------------------------------------------------
-uint8_t SSD1306UTF8::readUtf8Data(uint8_t ch) {
-  if (ch < 0xC0) {
-    // not first byte
-    if (m_utf8BufferedCount < 1 || m_utf8BufferedCount > 3) {
-      // Invalid data
-      m_utf8BufferedCount = 0;
-      return 0;
-    }
-    
-    m_utf8Buffer[m_utf8BufferedCount] = ch;
-    m_utf8BufferedCount += 1;
-
-    switch (m_utf8BufferedCount)
-    {
-    case 2:
-      if (m_utf8Buffer[0] >= 0xE0)  return 1;
-      // 2 bytes utf8, 0b110xxxxx 0b10xxxxxx
-      m_utf8BufferedCount = 0;
-      return 2;
-
-    case 3:
-      if (m_utf8Buffer[0] >= 0xF0)  return 1;
-      // 3 bytes utf8, 0b1110xxxx 0b10xxxxxx 0b10xxxxxx
-      m_utf8BufferedCount = 0;
-      return 2;
+bool SSD1306UTF8::utf8Glyph(uint32_t cp, GlyphInfo* g) const {
+  // find the glyph
+  const uint8_t *p_glyph_md = findUtf8Glyph(cp);
+  if (!p_glyph_md) return false;
 
-    case 4:
-      if (m_utf8Buffer[0] < 0xF0)  return 0;
-      // 4 bytes utf8, 0b11110xxx 0b10xxxxxx 0b10xxxxxx 0b10xxxxxx
-      m_utf8BufferedCount = 0;
-      return 2;
+  //font data
+  const uint8_t *font_utf8 = m_font + readFontBytes16(m_font + FONT_UTF8_HEADER_POS);
+  uint16_t fontUtf8Settings = readFontBytes16(font_utf8);
+  uint8_t fontUse24bitAddr = fontUtf8Settings & 0b1000;
+  uint8_t fontUseExtensionPlanes = fontUtf8Settings & 0b100;
+  uint8_t fontUsePadding = fontUtf8Settings & 0b10;
+  uint8_t fontIsFixedWidth = fontUtf8Settings & 0b1;
+  uint8_t glyphMetaLen = (fontUseExtensionPlanes ? 3 : 2) + (fontIsFixedWidth ? 0 : 1) + (fontUse24bitAddr ? 3 : 2);
+  uint8_t h = readFontByte(m_font + FONT_HEIGHT);
 
-    default:
-      m_utf8BufferedCount = 0;
-      return 0;
-    }
-  } else {
-    // first byte
-    m_utf8Buffer[0] = ch;
-    m_utf8BufferedCount = 1;
+  g->w = fontIsFixedWidth ? readFontByte(font_utf8 + FONT_UTF8_GLYPH_WIDTH) : readFontByte(p_glyph_md + (fontUseExtensionPlanes ? 3 : 2));
+  g->nr = (h + 7) / 8;
+  g->data = m_font + (fontUse24bitAddr ? readFontBytes24(p_glyph_md + glyphMetaLen - 3) : readFontBytes16(p_glyph_md + glyphMetaLen - 2));
+  g->spacing = fontUsePadding ? m_magFactor : 0;
+  g->shift = 0;
+  if (!fontIsFixedWidth && (h & 7)) {
+    g->shift = 8 - (h & 7);
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+uint8_t SSD1306UTF8::writeUtf8Glyph(uint32_t cp) {
+  if (m_col > m_clipC1) {
+    // Right of the clip rectangle, skip the glyph lookup.
     return 1;
   }
+  GlyphInfo g;
+  if (!utf8Glyph(cp, &g)) {
+    return 0;
+  }
+  writeGlyph(cp, g);
+  return 1;
 }
 //------------------------------------------------------------------------------
 size_t SSD1306UTF8::write(uint8_t ch) {
   if (!m_font) {
     return 0;
   }
+  if (m_listMode == LIST_RECORD) {
+    return listRecord(&ch, 1);
+  }
   
-  if (ch > 127) {
-    // char in utf8 
-    if (readUtf8Data(ch) > 1) {
-      return writeUtf8Glyph();
-    } else {
+  if (!m_codepage && (ch > 127 || m_utf8.pending())) {
+    // char in utf8
+    bool pending = m_utf8.pending();
+    uint8_t state = m_utf8.decode(ch);
+    if (state == UTF8_ACCEPT) {
+      return writeUtf8Glyph(m_utf8.codepoint());
+    }
+    if (state != UTF8_REJECT) {
+      // Need more bytes.
       return 1;
     }
+    m_utf8.reset();
+    if (m_utf8Replacement) {
+      writeCodepoint(m_utf8Replacement);
+    }
+    // A byte that breaks a truncated sequence may start a new character.
+    return pending ? write(ch) : 1;
   }
-  
-  uint8_t w = readFontByte(m_font + FONT_WIDTH);
-  uint8_t h = readFontByte(m_font + FONT_HEIGHT);
-  uint8_t nr = (h + 7) / 8;
-  uint8_t first = readFontByte(m_font + FONT_FIRST_CHAR);
-  uint8_t count = readFontByte(m_font + FONT_CHAR_COUNT);
-  const uint8_t* base = m_font + FONT_WIDTH_TABLE + ((fontSize() > 1 && fontSize() < 5) ? FONT_UTF8_EXTRA_HEADER_LEN : 0);
+  return writeAscii(ch);
+}
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::write(const uint8_t* buffer, size_t size) {
+  if (!m_font) {
+    return 0;
+  }
+  if (m_listMode == LIST_RECORD) {
+    return listRecord(buffer, size);
+  }
+  AsciiFont f;
+  bool loaded = false;
+  size_t n = 0;
+  while (n < size) {
+    size_t run = m_utf8.pending() ? 0 : asciiRun(buffer + n, size - n);
+    if (run == 0) {
+      // Control, utf-8 or codepage byte.
+      if (!write(buffer[n])) {
+        break;
+      }
+      n++;
+      continue;
+    }
+    if (!loaded) {
+      loadAsciiFont(&f);
+      loaded = true;
+    }
+    for (; run; run--, n++) {
+      if (!writeAsciiGlyph(f, buffer[n])) {
+        return n;
+      }
+    }
+  }
+  return n;
+}
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::asciiRun(const uint8_t* str, size_t len) {
+  size_t n = 0;
+#ifndef __AVR__
+  // Scan a word at a time for bytes outside ' ' to '~'.
+  const size_t ones = ~static_cast<size_t>(0) / 255;
+  const size_t highs = ones * 0X80;
+  while (len - n >= sizeof(size_t)) {
+    size_t x;
+    memcpy(&x, str + n, sizeof(size_t));
+    // High bit set in a byte that is below 0X20 or above 0X7E.
+    if ((((x - ones * 0X20) & ~x) | (x + ones) | x) & highs) {
+      break;
+    }
+    n += sizeof(size_t);
+  }
+#endif  // __AVR__
+  while (n < len && ' ' <= str[n] && str[n] <= '~') {
+    n++;
+  }
+  return n;
+}
+//------------------------------------------------------------------------------
+void SSD1306UTF8::loadAsciiFont(AsciiFont* f) const {
+  f->w = readFontByte(m_font + FONT_WIDTH);
+  f->h = readFontByte(m_font + FONT_HEIGHT);
+  f->nr = (f->h + 7) / 8;
+  f->first = readFontByte(m_font + FONT_FIRST_CHAR);
+  f->count = readFontByte(m_font + FONT_CHAR_COUNT);
+  f->fixed = fontSize() < 4;
+  f->base = m_font + FONT_WIDTH_TABLE +
+            (fontSupportsUtf8() ? FONT_UTF8_EXTRA_HEADER_LEN : 0);
+  f->spacing = letterSpacing();
+}
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::writeAscii(uint8_t ch) {
+  AsciiFont f;
+  loadAsciiFont(&f);
 
   if (ch == '\r') {
     setCol(0);
@@ -536,7 +1903,7 @@ size_t SSD1306UTF8::write(uint8_t ch) {
   }
   if (ch == '\n') {
     setCol(0);
-    uint8_t fr = m_magFactor * nr;
+    uint8_t fr = m_magFactor * f.nr;
 #if INCLUDE_SCROLLING
     uint8_t dr = displayRows();
     uint8_t tmpRow = m_row + fr;
@@ -557,59 +1924,52 @@ size_t SSD1306UTF8::write(uint8_t ch) {
 #endif  // INCLUDE_SCROLLING
     return 1;
   }
-  bool nfSpace = false;
-  if (first <= ch && ch < (first + count)) {
-    ch -= first;
+  return writeAsciiGlyph(f, ch);
+}
+//------------------------------------------------------------------------------
+bool SSD1306UTF8::asciiGlyph(const AsciiFont& f, uint8_t ch,
+                             GlyphInfo* g) const {
+  g->data = f.base;
+  g->w = f.w;
+  g->nr = f.nr;
+  g->shift = 0;
+  g->spacing = f.spacing;
+  if (f.first <= ch && ch < (f.first + f.count)) {
+    ch -= f.first;
   } else if (ENABLE_NONFONT_SPACE && ch == ' ') {
-    nfSpace = true;
+    // non-font space.
+    g->data = nullptr;
+    return true;
   } else {
     // Error if not in font.
-    return 0;
+    return false;
   }
-  uint8_t s = letterSpacing();
-  uint8_t thieleShift = 0;
-  if (nfSpace) {
-    // non-font space.
-  } else if (fontSize() < 4) {
+  if (f.fixed) {
     // Fixed width font.
-    base += nr * w * ch;
+    g->data += f.nr * f.w * ch;
   } else {
-    if (h & 7) {
-      thieleShift = 8 - (h & 7);
+    if (f.h & 7) {
+      g->shift = 8 - (f.h & 7);
     }
     uint16_t index = 0;
     for (uint8_t i = 0; i < ch; i++) {
-      index += readFontByte(base + i);
+      index += readFontByte(f.base + i);
     }
-    w = readFontByte(base + ch);
-    base += nr * index + count;
+    g->w = readFontByte(f.base + ch);
+    g->data += f.nr * index + f.count;
   }
-  uint8_t scol = m_col;
-  uint8_t srow = m_row;
-  uint8_t skip = m_skip;
-  for (uint8_t r = 0; r < nr; r++) {
-    for (uint8_t m = 0; m < m_magFactor; m++) {
-      skipColumns(skip);
-      if (r || m) {
-        setCursor(scol, m_row + 1);
-      }
-      for (uint8_t c = 0; c < w; c++) {
-        uint8_t b = nfSpace ? 0 : readFontByte(base + c + r * w);
-        if (thieleShift && (r + 1) == nr) {
-          b >>= thieleShift;
-        }
-        if (m_magFactor == 2) {
-          b = m ? b >> 4 : b & 0XF;
-          b = readFontByte(scaledNibble + b);
-          ssd1306WriteRamBuf(b);
-        }
-        ssd1306WriteRamBuf(b);
-      }
-      for (uint8_t i = 0; i < s; i++) {
-        ssd1306WriteRamBuf(0);
-      }
-    }
+  return true;
+}
+//------------------------------------------------------------------------------
+size_t SSD1306UTF8::writeAsciiGlyph(const AsciiFont& f, uint8_t ch) {
+  if (m_col > m_clipC1) {
+    // Right of the clip rectangle, skip the glyph lookup.
+    return 1;
   }
-  setRow(srow);
+  GlyphInfo g;
+  if (!asciiGlyph(f, ch, &g)) {
+    return 0;
+  }
+  writeGlyph(ch, g);
   return 1;
 }
@@ -31,9 +31,12 @@
  */
 #ifndef SSD1306UTF8_h
 #define SSD1306UTF8_h
+#include <stdarg.h>
+
 #include "Arduino.h"
 #include "SSD1306init.h"
 #include "fonts/allFonts.h"
+#include "utility/Utf8Decoder.h"
 //------------------------------------------------------------------------------
 /** SSD1306UTF8 version */
 #define SDD1306_ASCII_VERSION 10305
@@ -65,16 +68,79 @@
 #define ENABLE_NONFONT_SPACE 1
 #endif  // ENABLE_NONFONT_SPACE
 
+/**
+ * Initial character drawn for malformed utf-8 input.  Use 0XFFFD for the
+ * Unicode replacement character, any character of the font such as '?',
+ * or zero to silently drop malformed input.
+ */
+#ifndef UTF8_REPLACEMENT_CHAR
+#define UTF8_REPLACEMENT_CHAR 0
+#endif  // UTF8_REPLACEMENT_CHAR
+
+/**
+ * Number of rendered glyphs kept in RAM by the glyph cache.  A cached
+ * glyph is sent to the display as one burst with no font lookup or
+ * transform.  Each entry uses GLYPH_CACHE_BYTES plus 16 bytes of RAM.
+ * Zero disables the cache.
+ */
+#ifndef GLYPH_CACHE_SIZE
+#define GLYPH_CACHE_SIZE 0
+#endif  // GLYPH_CACHE_SIZE
+
+/**
+ * Largest glyph, rows times columns after magnification and including
+ * spacing, that will be cached.  Must be less than 256.
+ */
+#ifndef GLYPH_CACHE_BYTES
+#define GLYPH_CACHE_BYTES 64
+#endif  // GLYPH_CACHE_BYTES
+#if GLYPH_CACHE_BYTES > 255
+#error GLYPH_CACHE_BYTES must be less than 256
+#endif  // GLYPH_CACHE_BYTES > 255
+
 /** Dimension of TickerState pointer queue */
 #ifndef TICKER_QUEUE_DIM
 #define TICKER_QUEUE_DIM 6
 #endif  // TICKER_QUEUE_DIM
 
+/** Maximum number of character cells in a NumericField */
+#ifndef NUMERIC_FIELD_DIM
+#define NUMERIC_FIELD_DIM 8
+#endif  // NUMERIC_FIELD_DIM
+
+/**
+ * Set nonzero to support %f in printf().  The default is zero on AVR so
+ * printf() does not pull in floating point code, use printFixed().
+ */
+#ifndef PRINTF_FLOAT
+#ifdef __AVR__
+#define PRINTF_FLOAT 0
+#else  // __AVR__
+#define PRINTF_FLOAT 1
+#endif  // __AVR__
+#endif  // PRINTF_FLOAT
+
+/**
+ * Set nonzero to track which eight column blocks of display RAM are blank.
+ * Clears skip blocks that are known to be blank.  Uses 16 bytes of RAM.
+ */
+#ifndef TRACK_BLANK_BLOCKS
+#define TRACK_BLANK_BLOCKS 1
+#endif  // TRACK_BLANK_BLOCKS
+
 /** Use larger faster I2C code. */
 #ifndef OPTIMIZE_I2C
 #define OPTIMIZE_I2C 1
 #endif  // OPTIMIZE_I2C
 
+/**
+ * Maximum data bytes per I2C transaction for repeated bytes.  The Wire
+ * buffer is 32 bytes on AVR, one is used for the control byte.
+ */
+#ifndef I2C_REPEAT_CHUNK
+#define I2C_REPEAT_CHUNK 31
+#endif  // I2C_REPEAT_CHUNK
+
 /** If MULTIPLE_I2C_PORTS is nonzero,
     define a constructor with port selection. */
 #ifdef __AVR__
@@ -97,6 +163,28 @@
 /** Newline scrolls the RAM window. The app scrolls the display window. */
 #define SCROLL_MODE_APP 2
 //------------------------------------------------------------------------------
+// Values for setCharsetMode(uint8_t mode)
+/** Codepage for fonts without a utf-8 section, else utf-8. */
+#define CHARSET_MODE_AUTO 0
+/** Bytes above 127 are decoded as utf-8. */
+#define CHARSET_MODE_UTF8 1
+/** Bytes above 127 index the character table of the font directly. */
+#define CHARSET_MODE_CODEPAGE 2
+//------------------------------------------------------------------------------
+// Values for printField() align parameter.
+/** Text starts at the left edge of the field. */
+#define FIELD_ALIGN_LEFT 0
+/** Text ends at the right edge of the field. */
+#define FIELD_ALIGN_RIGHT 1
+/** Text is centered in the field. */
+#define FIELD_ALIGN_CENTER 2
+//------------------------------------------------------------------------------
+// Values for TextBox wrap.
+/** Break lines at blanks, long words are broken at any character. */
+#define TEXT_WRAP_WORD 0
+/** Break lines at any character, for CJK text. */
+#define TEXT_WRAP_CHAR 1
+//------------------------------------------------------------------------------
 // Values for writeDisplay() mode parameter.
 /** Write to Command register. */
 #define SSD1306_MODE_CMD 0
@@ -105,6 +193,11 @@
 /** Write to display RAM with possible buffering. */
 #define SSD1306_MODE_RAM_BUF 2
 //------------------------------------------------------------------------------
+#if __cplusplus >= 201402L
+// Compile-time rasterization needs the configuration above.
+#include "utility/Prerender.h"
+#endif  // __cplusplus >= 201402L
+//------------------------------------------------------------------------------
 /**
  * @brief Reset the display controller.
  *
@@ -139,6 +232,58 @@ struct TickerState {
   uint8_t queueUsed() const { return nQueue; }
 };
 //------------------------------------------------------------------------------
+/**
+ * @struct NumericField
+ * @brief Numeric field state, the characters last drawn in each cell.
+ */
+struct NumericField {
+  uint8_t col;                    ///< Column of the first cell.
+  uint8_t row;                    ///< Row of the field.
+  uint8_t cellWidth;              ///< Width of a cell in pixels.
+  uint8_t cells;                  ///< Number of cells.
+  uint8_t decimals;               ///< Digits after the decimal point.
+  char last[NUMERIC_FIELD_DIM];   ///< Characters on the display.
+  /// Redraw all cells on the next numericFieldPrint().
+  void invalidate() { memset(last, 0, sizeof(last)); }
+};
+//------------------------------------------------------------------------------
+/**
+ * @struct TextBox
+ * @brief Position and layout options for printTextBox().
+ */
+struct TextBox {
+  uint8_t col = 0;                   ///< Left column.
+  uint8_t row = 0;                   ///< Top row.
+  uint8_t width = 128;               ///< Width in pixels.
+  uint8_t rows = 8;                  ///< Height in rows.
+  uint8_t align = FIELD_ALIGN_LEFT;  ///< FIELD_ALIGN_LEFT, RIGHT or CENTER.
+  uint8_t lineSpacing = 0;           ///< Blank rows between lines.
+  uint8_t wrap = TEXT_WRAP_WORD;     ///< TEXT_WRAP_WORD or TEXT_WRAP_CHAR.
+  bool ellipsis = false;  ///< End the last line with "..." if text is cut.
+};
+//------------------------------------------------------------------------------
+/**
+ * @struct TextExtent
+ * @brief Size of a measured string.
+ */
+struct TextExtent {
+  size_t width = 0;   ///< Width in pixels including letter-spacing.
+  size_t glyphs = 0;  ///< Count of glyphs that will be displayed.
+};
+//------------------------------------------------------------------------------
+/**
+ * @struct TextLabel
+ * @brief A string rendered by renderLabel() for drawLabel().
+ */
+struct TextLabel {
+  /** Page format bitmap, rows pages of width columns. */
+  const uint8_t* data = nullptr;
+  /** Width in pixels. */
+  uint8_t width = 0;
+  /** Height in rows of eight pixels. */
+  uint8_t rows = 0;
+};
+//------------------------------------------------------------------------------
 /**
  * @class SSD1306UTF8
  * @brief SSD1306 base class
@@ -228,12 +373,18 @@ class SSD1306UTF8 : public Print {
    */
   uint8_t charWidth(uint8_t c) const;
   /**
-   * @brief Determine the width of a utf-8 character.
+   * @brief Determine the width of the last utf-8 character passed to write().
    *
-   * @param[in] c Character code.
    * @return Width of the character in pixels.
    */
-  const uint8_t charWidthUtf8();
+  const uint8_t charWidthUtf8() { return charWidthUtf8(m_utf8.codepoint()); }
+  /**
+   * @brief Determine the width of a utf-8 character.
+   *
+   * @param[in] cp Unicode codepoint of the character.
+   * @return Width of the character in pixels with magnification factor.
+   */
+  uint8_t charWidthUtf8(uint32_t cp) const;
   /**
    * @brief Clear the display and set the cursor to (0, 0).
    */
@@ -321,6 +472,99 @@ class SSD1306UTF8 : public Print {
    * @return Width of the field.
    */
   size_t fieldWidth(uint8_t n);
+  /**
+   * @brief Overwrite a field with text in one pass.
+   *
+   * The text is measured once and the field is written left to right,
+   * blank columns before the text, the text, then blank columns to the
+   * end of the field.  Each column is written once so there is no blank
+   * frame as with clearField() followed by print().  Text wider than the
+   * field is cut at the field edge.
+   *
+   * @param[in] col Field start column.
+   * @param[in] row Field start row.
+   * @param[in] width Field width in pixels.
+   * @param[in] str The text.
+   * @param[in] align FIELD_ALIGN_LEFT, FIELD_ALIGN_RIGHT or
+   *            FIELD_ALIGN_CENTER.
+   * @return The number of bytes of str written.
+   * @note The final cursor position will be after the text.
+   */
+  size_t printField(uint8_t col, uint8_t row, uint8_t width, const char* str,
+                    uint8_t align = FIELD_ALIGN_LEFT);
+  /**
+   * @brief Display text in a box with line wrap and alignment.
+   *
+   * Each glyph is measured once to find the line breaks and each line is
+   * written with the single pass of printField().  Lines are cut at the
+   * box edge, blank rows of the box are cleared.
+   *
+   * @param[in] box Position, size and layout options.
+   * @param[in] str The text.  '\n' starts a new line.
+   * @return Number of bytes of str displayed, less than strlen(str) if
+   *         the text did not fit in the box.
+   */
+  size_t printTextBox(const TextBox* box, const char* str);
+  /**
+   * @brief Record drawing in a display list instead of sending it.
+   *
+   * fill(), clear() and text written with write() or print() are saved
+   * in buf.  endRecord() then renders the list one page at a time and
+   * sends only the final value of each changed column, adjacent columns
+   * in one burst.  Bytes that a later operation overwrites are never
+   * sent.  Other drawing, such as drawLabel() or writeCodepoint(), sends
+   * the list and is then drawn at once.  Commands such as setContrast()
+   * are sent at once.  If buf fills, the list is sent and recording
+   * continues.
+   *
+   * @param[in] buf Buffer for a page image and the list.  Use at least
+   *            displayWidth() + displayWidth()/8 + 64 bytes.
+   * @param[in] size Size of buf.
+   * @return false if buf is too small.
+   */
+  bool beginRecord(uint8_t* buf, size_t size);
+  /**
+   * @brief Send the display list and stop recording.
+   */
+  void endRecord();
+  /**
+   * @return true if drawing is being recorded.
+   */
+  bool recording() const { return m_listMode != 0; }
+  /**
+   * @brief Start a group of drawing calls that make up one update.
+   *
+   * Within a frame, buffered data is not sent when the cursor moves,
+   * so transports keep bus transactions open until a command or the end
+   * of the frame.  If buf is given the frame is recorded as a display
+   * list, see beginRecord().  Frames may be nested, only the outer
+   * frame has an effect.
+   *
+   * @param[in] buf Buffer for a display list, nullptr for none.
+   * @param[in] size Size of buf.
+   * @param[in] holdTicker If true, tickerTick() does nothing until
+   *            endFrame() so a ticker is not drawn within the frame.
+   * @return false if buf is too small.  The frame is started without
+   *         a display list.
+   */
+  bool beginFrame(uint8_t* buf = nullptr, size_t size = 0,
+                  bool holdTicker = false);
+  /**
+   * @brief End a frame and send everything drawn in it.
+   *
+   * With SSD1306UTF8Async call wait() to know when the frame is on the
+   * display.
+   */
+  void endFrame();
+  /**
+   * @return true if a frame has been started.
+   */
+  bool inFrame() const { return m_frameDepth != 0; }
+  /**
+   * @return Time in microseconds from beginFrame() to the return of
+   *         endFrame() for the last frame.
+   */
+  uint32_t frameMicros() const { return m_frameMicros; }
   /**
    * @return The current font pointer.
    */
@@ -387,7 +631,7 @@ class SSD1306UTF8 : public Print {
   /**
    * @return utf8 glyph-spacing in pixels with magnification factor.
    */
-  const uint8_t utf8GlyphSpacing();
+  const uint8_t utf8GlyphSpacing() const;
   /**
    * @return The character magnification factor.
    */
@@ -404,6 +648,108 @@ class SSD1306UTF8 : public Print {
    * @brief Set the character magnification factor to two.
    */
   void set2X() { m_magFactor = 2; }
+  /**
+   * @brief Set the character magnification factor.
+   *
+   * @param[in] n Magnification factor, one to four.
+   */
+  void setMagFactor(uint8_t n);
+  /**
+   * @brief Set how bytes above 127 are interpreted by write().
+   *
+   * @param[in] mode One of the following.
+   *
+   * CHARSET_MODE_AUTO - codepage for fonts without a utf-8 section
+   *                     such as cp437font8x8, else utf-8.
+   *
+   * CHARSET_MODE_UTF8 - bytes above 127 are decoded as utf-8.
+   *
+   * CHARSET_MODE_CODEPAGE - bytes above 127 are looked up in the
+   *                         character table of the font, one byte per
+   *                         character.
+   */
+  void setCharsetMode(uint8_t mode);
+  /**
+   * @return true if bytes above 127 are codepage characters.
+   */
+  bool codepageMode() const { return m_codepage; }
+  /**
+   * @brief Render a string for later display by drawLabel().
+   *
+   * The string is drawn with the current font, magnification and invert
+   * mode into a caller owned buffer.  drawLabel() does not read the font.
+   * Carriage return and newline are not supported.
+   *
+   * @param[out] label The label to be initialized.
+   * @param[in] buf Buffer for the bitmap.  Must remain valid while the
+   *            label is used.
+   * @param[in] size Size of buf, at least fontRows() times strWidth(str).
+   * @param[in] str The string.
+   * @return true for success, false if buf is too small or no font is set.
+   */
+  bool renderLabel(TextLabel* label, uint8_t* buf, size_t size,
+                   const char* str);
+  /**
+   * @brief Display a label at the current cursor position.
+   *
+   * Each row of the label is sent as a single burst.  The column is
+   * advanced by the width of the label as for print().
+   *
+   * @param[in] label The label from renderLabel().
+   */
+  void drawLabel(const TextLabel* label);
+#if __cplusplus >= 201402L
+  /**
+   * @brief Display text rendered by PRERENDER_TEXT() at the current
+   *        cursor position.
+   *
+   * The font is not read.  The invert mode is applied as for print().
+   *
+   * @param[in] text The prerendered text.
+   */
+  template <size_t W, uint8_t R>
+  void drawPrerendered(const PrerenderedText<W, R>& text) {
+    writeFlashBitmap(text.data, W, R);
+  }
+  /**
+   * @brief Display text resolved by RESOLVE_TEXT() at the current
+   *        cursor position.
+   *
+   * No decoding or glyph search is done.  The magnification factor and
+   * invert mode are applied as for print().  The current font is not
+   * changed.
+   *
+   * @param[in] text The resolved text.
+   * @return Number of glyphs displayed.
+   */
+  template <size_t N>
+  size_t printResolved(const ResolvedText<N>& text) {
+#ifdef __AVR__
+    const uint8_t* font =
+        reinterpret_cast<const uint8_t*>(pgm_read_word(&text.font));
+#else   // __AVR__
+    const uint8_t* font = text.font;
+#endif  // __AVR__
+    return writeResolved(font, text.glyphs, N);
+  }
+#endif  // __cplusplus >= 201402L
+  /**
+   * @brief Restrict drawing to a rectangle.
+   *
+   * Text, fill() and clear() only change pixels in the clip rectangle.
+   * Columns and rows outside it are not sent to the display.  The cursor
+   * stops one column right of the rectangle.
+   *
+   * @param[in] c0 Left column.
+   * @param[in] c1 Right column.
+   * @param[in] r0 Top row.
+   * @param[in] r1 Bottom row.
+   */
+  void setClip(uint8_t c0, uint8_t c1, uint8_t r0, uint8_t r1);
+  /**
+   * @brief Allow drawing on the whole display.
+   */
+  void resetClip() { setClip(0, m_displayWidth - 1, 0, displayRows() - 1); }
   /**
    * @brief Set the current column number.
    *
@@ -421,6 +767,8 @@ class SSD1306UTF8 : public Print {
    *
    * @param[in] col The column number in pixels.
    * @param[in] row the row number in eight pixel rows.
+   * @note Address commands are sent before the next RAM byte and only
+   *       if the controller is not already at the cursor.
    */
   void setCursor(uint8_t col, uint8_t row);
   /**
@@ -435,6 +783,13 @@ class SSD1306UTF8 : public Print {
    * @param[in] pixels letter-spacing in pixels before magnification.
    */
   void setLetterSpacing(uint8_t pixels) { m_letterSpacing = pixels; }
+  /**
+   * @brief Set the character drawn for malformed utf-8 input.
+   *
+   * @param[in] cp Codepoint of the replacement character, 0XFFFD or a
+   *               character of the font.  Zero drops malformed input.
+   */
+  void setUtf8Replacement(uint32_t cp) { m_utf8Replacement = cp; }
   /**
    * @brief Set the current row number.
    *
@@ -445,9 +800,16 @@ class SSD1306UTF8 : public Print {
    * @brief Write a command byte to the display controller.
    *
    * @param[in] c The command byte.
-   * @note The byte will immediately be sent to the controller.
+   * @note The byte will immediately be sent to the controller.  The RAM
+   *       address is sent again before the next RAM byte.
    */
-  void ssd1306WriteCmd(uint8_t c) { writeDisplay(c, SSD1306_MODE_CMD); }
+  void ssd1306WriteCmd(uint8_t c) {
+    // The command may change the RAM address or start line.
+    m_hwCol = 0XFF;
+    m_hwPage = 0XFF;
+    m_startLineSent = false;
+    writeDisplay(c, SSD1306_MODE_CMD);
+  }
   /**
    * @brief Write a byte to RAM in the display controller.
    *
@@ -463,6 +825,16 @@ class SSD1306UTF8 : public Print {
    *       or ssd1306WriteRam.
    */
   void ssd1306WriteRamBuf(uint8_t c);
+  /**
+   * @brief Write a byte to RAM in the display controller n times.
+   *
+   * Skipped pixels and the display width are handled as in
+   * ssd1306WriteRamBuf.
+   *
+   * @param[in] c The data byte.
+   * @param[in] n Number of times to write c.
+   */
+  void ssd1306WriteRamRepeat(uint8_t c, uint8_t n);
   /**
    * @brief Skip leading pixels writing characters to display display RAM.
    *
@@ -475,7 +847,50 @@ class SSD1306UTF8 : public Print {
    * @param[in] str The pointer to string.
    * @return the width of the string in pixels.
    */
-  const size_t strWidth(const char* str);
+  const size_t strWidth(const char* str) const {
+    return measureText(str, strlen(str)).width;
+  }
+  /**
+   * @brief Measure a string in one pass.
+   *
+   * The string is decoded with its own state so it may be called while
+   * a utf-8 character is partly written.  Magnification and
+   * letter-spacing are included, characters not in the font are ignored.
+   *
+   * @param[in] str The pointer to string, need not be null terminated.
+   * @param[in] len Length of the string in bytes.
+   * @return Width in pixels and count of glyphs.
+   */
+  TextExtent measureText(const char* str, size_t len) const;
+  /**
+   * @brief Initialize a NumericField struct.
+   *
+   * Each character of the field has a cell as wide as the widest digit
+   * of the current font, so call this after setFont() and
+   * setMagFactor().
+   *
+   * @param[in,out] field Numeric field state.
+   * @param[in] col Column of the first cell.
+   * @param[in] row Row of the field.
+   * @param[in] cells Number of cells, at most NUMERIC_FIELD_DIM.  The
+   *            sign and decimal point use a cell.
+   * @param[in] decimals Digits after the decimal point.
+   */
+  void numericFieldInit(NumericField* field, uint8_t col, uint8_t row,
+                        uint8_t cells, uint8_t decimals = 0);
+  /**
+   * @brief Display a value in a numeric field.
+   *
+   * The value is right aligned with leading blanks.  Only cells that
+   * differ from the last value are sent to the display.  A value that
+   * does not fit is shown as '#' in every cell.
+   *
+   * @param[in,out] field Numeric field state.
+   * @param[in] value Value scaled by 10^decimals.  For two decimals,
+   *            1234 is displayed as 12.34.
+   * @return Number of cells redrawn.
+   */
+  uint8_t numericFieldPrint(NumericField* field, int32_t value);
   /**
    * @brief Initialize TickerState struct.
    *
@@ -509,6 +924,8 @@ class SSD1306UTF8 : public Print {
   /**
    * @brief Advance ticker by one pixel.
    *
+   * Does nothing within a frame started with holdTicker true.
+   *
    * @param[in,out] state Ticker state.
    * @return Number of entries in text pointer queue or -1 if an error occurs.
    */
@@ -520,13 +937,234 @@ class SSD1306UTF8 : public Print {
    * @return one for success else zero.
    */
   size_t write(uint8_t ch);
+  /**
+   * @brief Display a string.
+   *
+   * Runs of printable ASCII are drawn with the font header read once.
+   * Other bytes are handled by write(uint8_t).
+   *
+   * @param[in] buffer The bytes to display.
+   * @param[in] size Number of bytes.
+   * @return Number of bytes written.  Stops at the first character that
+   *         is not in the font.
+   */
+  size_t write(const uint8_t* buffer, size_t size);
+  /**
+   * @brief Display a character given by its codepoint.
+   *
+   * No utf-8 encoding or decoding is done.  Codepoints below 128,
+   * including carriage return and newline, are handled like write().
+   *
+   * @param[in] cp Unicode codepoint of the character.
+   * @return one for success else zero.
+   */
+  size_t writeCodepoint(uint32_t cp);
+  /**
+   * @brief Display a UTF-16 string.
+   *
+   * Surrogate pairs are combined.  Unpaired surrogates are replaced as
+   * set by setUtf8Replacement().
+   *
+   * @param[in] str The UTF-16 code units, need not be null terminated.
+   * @param[in] len Number of code units.
+   * @return Number of code units displayed.  Stops at the first
+   *         character that is not in the font.
+   */
+  size_t writeUtf16(const uint16_t* str, size_t len);
+  /**
+   * @brief Display a string of codepoints.
+   *
+   * @param[in] str The codepoints, need not be null terminated.
+   * @param[in] len Number of codepoints.
+   * @return Number of codepoints displayed.  Stops at the first
+   *         character that is not in the font.
+   */
+  size_t writeUtf32(const uint32_t* str, size_t len);
+  /**
+   * @brief Display a signed integer.
+   *
+   * Formats into a stack buffer, no heap is used.
+   *
+   * @param[in] value The value.
+   * @param[in] width Minimum field width in characters.
+   * @param[in] pad ' ' for leading blanks, '0' for zeros after the sign.
+   * @return Number of bytes written.
+   */
+  size_t printInt(int32_t value, uint8_t width = 0, char pad = ' ');
+  /**
+   * @brief Display a scaled integer as a decimal fraction.
+   *
+   * No floating point code is used, printFixed(-1234, 2) displays -12.34.
+   *
+   * @param[in] value The value times 10^decimals.
+   * @param[in] decimals Digits after the decimal point, at most nine.
+   * @param[in] width Minimum field width in characters.
+   * @param[in] pad ' ' for leading blanks, '0' for zeros after the sign.
+   * @return Number of bytes written.
+   */
+  size_t printFixed(int32_t value, uint8_t decimals, uint8_t width = 0,
+                    char pad = ' ');
+  /**
+   * @brief Formatted print without heap allocation.
+   *
+   * Supports %d %i %u %x %X %c %s %f and %%, the flags '-', '0', '+' and
+   * ' ', a field width, a precision and the 'l' length modifier.  Text
+   * between conversions is written as one run.  %f requires
+   * PRINTF_FLOAT, precision is limited to nine digits.
+   *
+   * @param[in] format The format string.
+   * @return Number of bytes written.
+   */
+  size_t printf(const char* format, ...)
+      __attribute__((format(printf, 2, 3)));
 
  protected:
   uint16_t fontSize() const;
+  const uint8_t* findUtf8Glyph(uint32_t g) const;
   virtual void writeDisplay(uint8_t b, uint8_t mode) = 0;
-  uint8_t readUtf8Data(uint8_t ch);
-  uint8_t writeUtf8Glyph();
-  uint32_t utf8BufferToUnicode();
+  /**
+   * @brief Send a data byte n times.
+   *
+   * Transports override this to send the bytes in as few bus
+   * transactions as possible.
+   *
+   * @param[in] b The data byte.
+   * @param[in] n Number of times to send b.
+   */
+  virtual void writeDisplayRepeat(uint8_t b, uint8_t n) {
+    while (n--) {
+      writeDisplay(b, SSD1306_MODE_RAM_BUF);
+    }
+  }
+  /**
+   * @brief Send a block of data bytes.
+   *
+   * Transports override this to send the bytes in as few bus
+   * transactions as possible.
+   *
+   * @param[in] buf The data bytes.
+   * @param[in] n Number of bytes.
+   */
+  virtual void writeDisplayBuf(const uint8_t* buf, uint8_t n) {
+    while (n--) {
+      writeDisplay(*buf++, SSD1306_MODE_RAM_BUF);
+    }
+  }
+  /**
+   * @brief Send data bytes buffered by SSD1306_MODE_RAM_BUF.
+   *
+   * Called when the cursor is moved.  Transports that hold a bus
+   * transaction open for buffered bytes override this to close it.
+   */
+  virtual void writeDisplayFlush() {}
+  void syncAddress();
+  /** Display list operation, text bytes follow a text operation. */
+  struct ListOp {
+    const uint8_t* font;  // Font for text, nullptr for fill.
+    uint16_t len;         // Count of text bytes.
+    uint8_t col;          // Cursor column or fill start column.
+    uint8_t row;          // Cursor row or fill start row.
+    uint8_t c1;           // Fill end column.
+    uint8_t r1;           // Fill end row.
+    uint8_t filler;       // Fill byte.
+    uint8_t magFactor;
+    uint8_t invertMask;
+    uint8_t letterSpacing;
+    uint8_t skip;
+    bool codepage;
+    uint8_t clipC0;
+    uint8_t clipC1;
+    uint8_t top;     // First row changed.
+    uint8_t bottom;  // Last row changed.
+    Utf8Decoder utf8;
+  };
+#if TRACK_BLANK_BLOCKS
+  /** @return Bit for the block of col in m_blank. */
+  static uint16_t blankBit(uint8_t col) {
+    return col < 128 ? 1U << (col >> 3) : 0;
+  }
+  /** @return RAM page of a cursor row. */
+  uint8_t ramPage(uint8_t row) const {
+#if INCLUDE_SCROLLING
+    return (row + m_pageOffset) & 7;
+#else   // INCLUDE_SCROLLING
+    return row & 7;
+#endif  // INCLUDE_SCROLLING
+  }
+  void blankClear(uint8_t row, uint8_t col, uint8_t n);
+  void blankSet(uint8_t row, uint8_t c0, uint8_t c1);
+  /** Nothing is known to be blank. */
+  void blankReset() { memset(m_blank, 0, sizeof(m_blank)); }
+#endif  // TRACK_BLANK_BLOCKS
+  ListOp* listAppend(size_t n);
+  bool listCapture();
+  void listFlush();
+  size_t listRecord(const uint8_t* buf, size_t n);
+  size_t listRecordText(const uint8_t* buf, size_t n);
+  void listStore(const uint8_t* buf, uint8_t c, uint8_t n);
+  /** ASCII section of the current font. */
+  struct AsciiFont {
+    const uint8_t* base;  // Width table or glyph data.
+    uint8_t w;            // Width of fixed width fonts.
+    uint8_t h;            // Height in pixels.
+    uint8_t nr;           // Height in rows.
+    uint8_t first;        // First character.
+    uint8_t count;        // Number of characters.
+    uint8_t spacing;      // Letter-spacing in pixels.
+    bool fixed;           // Fixed width font.
+  };
+  static size_t asciiRun(const uint8_t* str, size_t len);
+  void loadAsciiFont(AsciiFont* f) const;
+  uint8_t advance(uint32_t cp, uint8_t first, uint8_t count, uint8_t s,
+                  uint8_t us) const;
+  size_t writeField(uint8_t col, uint8_t row, uint8_t width, const char* str,
+                    size_t len, size_t textWidth, uint8_t align,
+                    const char* suffix = nullptr);
+  size_t writePadded(const char* str, size_t len, char sign, uint8_t width,
+                     char pad, bool left);
+  size_t writePad(char c, uint8_t n);
+  size_t writeAscii(uint8_t ch);
+  size_t writeAsciiGlyph(const AsciiFont& f, uint8_t ch);
+  /** Location and layout of one glyph. */
+  struct GlyphInfo {
+    const uint8_t* data;  // Glyph data, nullptr for non-font space.
+    uint8_t w;            // Width before magnification.
+    uint8_t nr;           // Height in rows before magnification.
+    uint8_t shift;        // Thiele shift of the last row.
+    uint8_t spacing;      // Spacing columns after magnification.
+  };
+  bool asciiGlyph(const AsciiFont& f, uint8_t ch, GlyphInfo* g) const;
+  bool utf8Glyph(uint32_t cp, GlyphInfo* g) const;
+  bool nextChar(const char* str, size_t len, size_t* i, Utf8Decoder* decoder,
+                uint32_t* cp) const;
+  void renderGlyph(const GlyphInfo& g, uint8_t* out, uint8_t stride) const;
+  void writeBitmap(const uint8_t* data, uint8_t width, uint8_t rows);
+  void writeFlashBitmap(const uint8_t* data, uint8_t width, uint8_t rows);
+  size_t writeResolved(const uint8_t* font, const uint8_t* glyphs, size_t n);
+  void writeGlyph(uint32_t cp, const GlyphInfo& g);
+  void writeRamBurst(const uint8_t* buf, uint8_t n);
+  void advanceColumns(uint8_t n);
+  uint8_t clipColumns(uint8_t n, uint8_t* lead);
+  bool rowVisible(uint8_t row) const {
+    return m_clipR0 <= row && row <= m_clipR1;
+  }
+#if GLYPH_CACHE_SIZE
+  /** A rendered glyph with the invert mask applied. */
+  struct GlyphCacheEntry {
+    const uint8_t* font = nullptr;  // Font, nullptr if unused.
+    uint32_t cp;                    // Codepoint.
+    uint32_t used = 0;              // Time of last use for LRU eviction.
+    uint8_t mag;                    // Magnification factor.
+    uint8_t invert;                 // Invert mask.
+    uint8_t spacing;                // Spacing columns.
+    uint8_t cols;                   // Columns per page including spacing.
+    uint8_t pages;                  // Pages.
+    bool codepage;                  // cp is a codepage byte.
+    uint8_t data[GLYPH_CACHE_BYTES];
+  };
+  bool writeCachedGlyph(uint32_t cp, const GlyphInfo& g);
+#endif  // GLYPH_CACHE_SIZE
+  uint8_t writeUtf8Glyph(uint32_t cp);
   uint8_t m_col;            // Cursor column.
   uint8_t m_row;            // Cursor RAM row.
   uint8_t m_displayWidth;   // Display width.
@@ -539,11 +1177,39 @@ class SSD1306UTF8 : public Print {
   uint8_t m_scrollMode = INITIAL_SCROLL_MODE;  // Scroll mode for newline.
 #endif                                         // INCLUDE_SCROLLING
   uint8_t m_skip = 0;
+  uint8_t m_clipC0 = 0;      // Clip rectangle left column.
+  uint8_t m_clipC1 = 0;      // Clip rectangle right column.
+  uint8_t m_clipR0 = 0;      // Clip rectangle top row.
+  uint8_t m_clipR1 = 0;      // Clip rectangle bottom row.
+  uint8_t m_hwCol = 0XFF;   // Controller column pointer, 0XFF if unknown.
+  uint8_t m_hwPage = 0XFF;  // Controller page, 0XFF if unknown.
+  bool m_startLineSent = false;  // Controller start line is m_startLine.
+#if TRACK_BLANK_BLOCKS
+  uint16_t m_blank[8] = {0};  // Bit set if a RAM block is all zero.
+#endif  // TRACK_BLANK_BLOCKS
+  uint8_t m_listMode = 0;    // Display list mode, zero if not recording.
+  uint8_t* m_listBuf = nullptr;  // Page image, changed column bits, list.
+  size_t m_listSize = 0;    // Size of m_listBuf.
+  size_t m_listUsed = 0;    // End of the list in m_listBuf.
+  size_t m_listText = 0;    // Offset of the open text operation or zero.
+  uint8_t m_listEndCol = 0;  // Cursor after the open text operation.
+  uint8_t m_listEndRow = 0;
+  uint8_t m_frameDepth = 0;     // Nesting depth of beginFrame().
+  bool m_frameList = false;     // The frame is recorded as a display list.
+  bool m_frameHoldTicker = false;  // tickerTick() waits for endFrame().
+  uint32_t m_frameStart = 0;    // micros() at beginFrame().
+  uint32_t m_frameMicros = 0;   // Duration of the last frame.
   const uint8_t* m_font = nullptr;  // Current font.
   uint8_t m_invertMask = 0;         // font invert mask
   uint8_t m_magFactor = 1;          // Magnification factor.
+  uint8_t m_charsetMode = CHARSET_MODE_AUTO;  // Charset mode for write().
+  bool m_codepage = false;          // Bytes above 127 are codepage chars.
 
-  uint8_t m_utf8Buffer[4];          // buffer for reading utf-8 char
-  uint8_t m_utf8BufferedCount = 0;  // buffered bytes count
+  Utf8Decoder m_utf8;                                  // utf-8 decoder state
+  uint32_t m_utf8Replacement = UTF8_REPLACEMENT_CHAR;  // malformed input
+#if GLYPH_CACHE_SIZE
+  GlyphCacheEntry m_glyphCache[GLYPH_CACHE_SIZE];
+  uint32_t m_glyphCacheTick = 0;
+#endif  // GLYPH_CACHE_SIZE
 };
 #endif  // SSD1306UTF8_h
@@ -0,0 +1,198 @@
+/**
+ * Copyright (c) 2011-2023 Bill Greiman
+ * This file is part of the Arduino SSD1306Ascii Library
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * @file SSD1306UTF8Async.h
+ * @brief Base class for asynchronous transports.
+ */
+#ifndef SSD1306UTF8Async_h
+#define SSD1306UTF8Async_h
+#include "SSD1306UTF8.h"
+//------------------------------------------------------------------------------
+/** Size of each of the two staging blocks, at most 255. */
+#ifndef ASYNC_BLOCK_SIZE
+#define ASYNC_BLOCK_SIZE 32
+#endif  // ASYNC_BLOCK_SIZE
+//------------------------------------------------------------------------------
+/**
+ * @class SSD1306UTF8Async
+ * @brief Base class for transports that send in the background.
+ *
+ * Bytes are staged in one of two blocks while the other block is on the
+ * wire, so text is rendered into the next block while the previous one
+ * is sent.  A block is a list of segments, each a header byte followed
+ * by up to 127 command or data bytes.
+ *
+ * A derived class implements startTransfer() for its DMA or interrupt
+ * driver and calls transferDone() when the transfer is complete.
+ */
+class SSD1306UTF8Async : public SSD1306UTF8 {
+ public:
+  /** @return true if a block is being sent. */
+  bool busy() const { return __atomic_load_n(&m_txBusy, __ATOMIC_ACQUIRE); }
+  /**
+   * @brief Send the staged bytes.
+   *
+   * Waits for the previous block only if it is still being sent.
+   */
+  void flush() {
+    if (m_used) {
+      submit();
+    }
+  }
+  /**
+   * @brief Set a function called each time a block has been sent.
+   *
+   * The callback runs in the context that calls transferDone(), often an
+   * interrupt handler.
+   *
+   * @param[in] callback The function, nullptr for none.
+   * @param[in] arg Argument passed to callback.
+   */
+  void setCallback(void (*callback)(void*), void* arg = nullptr) {
+    m_callback = callback;
+    m_callbackArg = arg;
+  }
+  /**
+   * @brief Called by the driver when a transfer is complete.
+   *
+   * Starts the next segment of the block or frees the block and calls
+   * the callback.
+   */
+  void transferDone() {
+    if (m_txNext < m_txEnd) {
+      startNext();
+      return;
+    }
+    // Release the block to the renderer.
+    __atomic_store_n(&m_txBusy, false, __ATOMIC_RELEASE);
+    if (m_callback) {
+      m_callback(m_callbackArg);
+    }
+  }
+  /** @brief Send the staged bytes and wait until all have been sent. */
+  void wait() {
+    flush();
+    while (busy()) {
+      yield();
+    }
+  }
+
+ protected:
+  /**
+   * @brief Start sending bytes.
+   *
+   * Must not wait for the transfer.  Call transferDone() when it is
+   * complete, this may be done before startTransfer() returns.
+   *
+   * @param[in] buf The bytes, valid until transferDone() is called.
+   * @param[in] n Number of bytes.
+   * @param[in] mode SSD1306_MODE_CMD or SSD1306_MODE_RAM.
+   */
+  virtual void startTransfer(const uint8_t* buf, uint8_t n, uint8_t mode) = 0;
+
+  void writeDisplay(uint8_t b, uint8_t mode) {
+    stage(&b, 1, mode == SSD1306_MODE_CMD ? 0 : 0X80);
+  }
+  void writeDisplayRepeat(uint8_t b, uint8_t n) {
+    uint8_t buf[16];
+    memset(buf, b, sizeof(buf));
+    while (n) {
+      uint8_t k = n < sizeof(buf) ? n : sizeof(buf);
+      stage(buf, k, 0X80);
+      n -= k;
+    }
+  }
+  void writeDisplayBuf(const uint8_t* buf, uint8_t n) {
+    stage(buf, n, 0X80);
+  }
+  void writeDisplayFlush() {
+    // Keep the bus busy, send now only if it is idle.
+    if (m_used && !busy()) {
+      submit();
+    }
+  }
+
+ private:
+  void stage(const uint8_t* buf, uint8_t n, uint8_t data) {
+    while (n) {
+      uint8_t* block = m_block[m_fill];
+      if (m_used == 0 || (block[m_seg] & 0X80) != data ||
+          (block[m_seg] & 0X7F) == 0X7F) {
+        if (m_used > ASYNC_BLOCK_SIZE - 2) {
+          submit();
+          continue;
+        }
+        m_seg = m_used++;
+        block[m_seg] = data;
+      }
+      uint8_t k = ASYNC_BLOCK_SIZE - m_used;
+      if (k == 0) {
+        submit();
+        continue;
+      }
+      if (k > 0X7F - (block[m_seg] & 0X7F)) {
+        k = 0X7F - (block[m_seg] & 0X7F);
+      }
+      if (k > n) {
+        k = n;
+      }
+      memcpy(block + m_used, buf, k);
+      block[m_seg] += k;
+      m_used += k;
+      buf += k;
+      n -= k;
+    }
+  }
+  void startNext() {
+    const uint8_t* seg = m_txNext;
+    uint8_t n = seg[0] & 0X7F;
+    m_txNext = seg + 1 + n;
+    startTransfer(seg + 1, n,
+                  seg[0] & 0X80 ? SSD1306_MODE_RAM : SSD1306_MODE_CMD);
+  }
+  void submit() {
+    while (busy()) {
+      yield();
+    }
+    m_txNext = m_block[m_fill];
+    m_txEnd = m_txNext + m_used;
+    m_fill ^= 1;
+    m_used = 0;
+    // m_txNext and m_txEnd are visible to transferDone() after this.
+    __atomic_store_n(&m_txBusy, true, __ATOMIC_RELEASE);
+    startNext();
+  }
+
+  uint8_t m_block[2][ASYNC_BLOCK_SIZE];
+  uint8_t m_fill = 0;  // Index of the staging block.
+  uint8_t m_used = 0;  // Bytes used in the staging block.
+  uint8_t m_seg = 0;   // Offset of the open segment header.
+  bool m_txBusy = false;  // Written with release, read with acquire.
+  const uint8_t* m_txNext;
+  const uint8_t* m_txEnd;
+  void (*m_callback)(void*) = nullptr;
+  void* m_callbackArg = nullptr;
+};
+#endif  // SSD1306UTF8Async_h
@@ -89,6 +89,33 @@ class SSD1306UTF8AvrI2c : public SSD1306UTF8 {
       m_nData = 0;
     }
   }
+  void writeDisplayRepeat(uint8_t b, uint8_t n) {
+    if (m_nData == 0) {
+      m_i2c.start((m_i2cAddr << 1) | I2C_WRITE);
+      m_i2c.write(0X40);
+    }
+    while (n--) {
+      m_i2c.write(b);
+    }
+    // Leave the transaction open, as for SSD1306_MODE_RAM_BUF.
+    m_nData = 1;
+  }
+  void writeDisplayBuf(const uint8_t* buf, uint8_t n) {
+    if (m_nData == 0) {
+      m_i2c.start((m_i2cAddr << 1) | I2C_WRITE);
+      m_i2c.write(0X40);
+    }
+    while (n--) {
+      m_i2c.write(*buf++);
+    }
+    m_nData = 1;
+  }
+  void writeDisplayFlush() {
+    if (m_nData) {
+      m_i2c.stop();
+      m_nData = 0;
+    }
+  }
 
  protected:
   AvrI2c m_i2c;
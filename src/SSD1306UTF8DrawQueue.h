@@ -0,0 +1,242 @@
+/**
+ * Copyright (c) 2011-2023 Bill Greiman
+ * This file is part of the Arduino SSD1306Ascii Library
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * @file SSD1306UTF8DrawQueue.h
+ * @brief Lock-free queue of draw commands for interrupt handlers and tasks.
+ */
+#ifndef SSD1306UTF8DrawQueue_h
+#define SSD1306UTF8DrawQueue_h
+#include "SSD1306UTF8.h"
+//------------------------------------------------------------------------------
+/** Number of commands in a DrawQueue, a power of two, at most 128. */
+#ifndef DRAW_QUEUE_DIM
+#define DRAW_QUEUE_DIM 16
+#endif  // DRAW_QUEUE_DIM
+
+/** Maximum number of text bytes in one DrawQueue command. */
+#ifndef DRAW_TEXT_DIM
+#define DRAW_TEXT_DIM 8
+#endif  // DRAW_TEXT_DIM
+//------------------------------------------------------------------------------
+// Values for DrawCmd op.
+/** setCursor(arg[0], arg[1]) */
+#define DRAW_OP_CURSOR 0
+/** write(text, len) */
+#define DRAW_OP_TEXT 1
+/** fill(arg[0], arg[1], arg[2], arg[3], filler) */
+#define DRAW_OP_FILL 2
+/** setFont() with a font from the table given to DrawQueue */
+#define DRAW_OP_FONT 3
+//------------------------------------------------------------------------------
+/**
+ * @struct DrawCmd
+ * @brief A draw command in a DrawQueue.
+ */
+struct DrawCmd {
+  uint8_t op;                ///< One of the DRAW_OP_ values.
+  uint8_t len;               ///< Text length or fill value.
+  uint8_t arg[4];            ///< Cursor, fill rectangle or font index.
+  char text[DRAW_TEXT_DIM];  ///< Text for DRAW_OP_TEXT.
+};
+//------------------------------------------------------------------------------
+/**
+ * @class DrawQueue
+ * @brief Single producer, single consumer ring of draw commands.
+ *
+ * One interrupt handler or task posts commands, they never wait and
+ * return false if the queue is full.  The main loop or a display task
+ * calls drain() to draw them.  Use one queue per posting context.
+ */
+class DrawQueue {
+ public:
+  /**
+   * @param[in] fonts Table of fonts for postFont(), nullptr for none.
+   * @param[in] nFonts Number of fonts in the table.
+   */
+  explicit DrawQueue(const uint8_t* const* fonts = nullptr,
+                     uint8_t nFonts = 0)
+      : m_fonts(fonts), m_nFonts(nFonts) {}
+  /**
+   * @brief Post setCursor().
+   *
+   * @param[in] col The column in pixels.
+   * @param[in] row The row in pages.
+   * @return false if the queue is full.
+   */
+  bool postCursor(uint8_t col, uint8_t row) {
+    DrawCmd* cmd = slot();
+    if (!cmd) {
+      return false;
+    }
+    cmd->op = DRAW_OP_CURSOR;
+    cmd->arg[0] = col;
+    cmd->arg[1] = row;
+    return publish();
+  }
+  /**
+   * @brief Post text.
+   *
+   * Text longer than DRAW_TEXT_DIM bytes is cut before the first
+   * UTF-8 character that does not fit.
+   *
+   * @param[in] str The text.
+   * @return false if the queue is full.
+   */
+  bool postText(const char* str) {
+    DrawCmd* cmd = slot();
+    if (!cmd) {
+      return false;
+    }
+    uint8_t n = 0;
+    while (n < DRAW_TEXT_DIM && str[n]) {
+      n++;
+    }
+    if (n == DRAW_TEXT_DIM && str[n]) {
+      while (n && (str[n] & 0XC0) == 0X80) {
+        n--;
+      }
+    }
+    cmd->op = DRAW_OP_TEXT;
+    cmd->len = n;
+    memcpy(cmd->text, str, n);
+    return publish();
+  }
+  /**
+   * @brief Post fill().
+   *
+   * @param[in] c0 Start column.
+   * @param[in] c1 End column.
+   * @param[in] r0 Start row.
+   * @param[in] r1 End row.
+   * @param[in] filler Byte written to each column.
+   * @return false if the queue is full.
+   */
+  bool postFill(uint8_t c0, uint8_t c1, uint8_t r0, uint8_t r1,
+                uint8_t filler) {
+    DrawCmd* cmd = slot();
+    if (!cmd) {
+      return false;
+    }
+    cmd->op = DRAW_OP_FILL;
+    cmd->len = filler;
+    cmd->arg[0] = c0;
+    cmd->arg[1] = c1;
+    cmd->arg[2] = r0;
+    cmd->arg[3] = r1;
+    return publish();
+  }
+  /**
+   * @brief Post setFont().
+   *
+   * @param[in] index Index in the font table, out of range is ignored.
+   * @return false if the queue is full.
+   */
+  bool postFont(uint8_t index) {
+    DrawCmd* cmd = slot();
+    if (!cmd) {
+      return false;
+    }
+    cmd->op = DRAW_OP_FONT;
+    cmd->arg[0] = index;
+    return publish();
+  }
+  /**
+   * @brief Draw posted commands.  Call from the consumer only.
+   *
+   * @param[in] oled The display.
+   * @param[in] maxCmds Maximum number of commands to draw.
+   * @return Number of commands drawn.
+   */
+  uint8_t drain(SSD1306UTF8* oled, uint8_t maxCmds = DRAW_QUEUE_DIM) {
+    uint8_t tail = m_tail;
+    uint8_t head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+    uint8_t n = 0;
+    while (tail != head && n < maxCmds) {
+      const DrawCmd* cmd = &m_cmd[tail & (DRAW_QUEUE_DIM - 1)];
+      switch (cmd->op) {
+        case DRAW_OP_CURSOR:
+          oled->setCursor(cmd->arg[0], cmd->arg[1]);
+          break;
+        case DRAW_OP_TEXT:
+          oled->write(reinterpret_cast<const uint8_t*>(cmd->text), cmd->len);
+          break;
+        case DRAW_OP_FILL:
+          oled->fill(cmd->arg[0], cmd->arg[1], cmd->arg[2], cmd->arg[3],
+                     cmd->len);
+          break;
+        case DRAW_OP_FONT:
+          if (cmd->arg[0] < m_nFonts) {
+            oled->setFont(m_fonts[cmd->arg[0]]);
+          }
+          break;
+      }
+      // Free the slot after it has been used.
+      __atomic_store_n(&m_tail, ++tail, __ATOMIC_RELEASE);
+      n++;
+    }
+    return n;
+  }
+  /**
+   * @return Number of commands lost because the queue was full, stops
+   *         at 255.
+   */
+  uint8_t dropped() const {
+    return __atomic_load_n(&m_dropped, __ATOMIC_RELAXED);
+  }
+  /** @return true if no commands are waiting.  Call from the consumer. */
+  bool empty() const {
+    return m_tail == __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+  }
+
+ private:
+  static_assert((DRAW_QUEUE_DIM & (DRAW_QUEUE_DIM - 1)) == 0 &&
+                    DRAW_QUEUE_DIM <= 128,
+                "DRAW_QUEUE_DIM must be a power of two, at most 128");
+  // Free slot for the producer or nullptr if the queue is full.
+  DrawCmd* slot() {
+    uint8_t tail = __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE);
+    if ((uint8_t)(m_head - tail) >= DRAW_QUEUE_DIM) {
+      if (m_dropped != 0XFF) {
+        // One byte so the consumer never sees a torn count.
+        __atomic_store_n(&m_dropped, m_dropped + 1, __ATOMIC_RELAXED);
+      }
+      return nullptr;
+    }
+    return &m_cmd[m_head & (DRAW_QUEUE_DIM - 1)];
+  }
+  // Make the command in the slot visible to the consumer.
+  bool publish() {
+    __atomic_store_n(&m_head, (uint8_t)(m_head + 1), __ATOMIC_RELEASE);
+    return true;
+  }
+
+  DrawCmd m_cmd[DRAW_QUEUE_DIM];
+  const uint8_t* const* m_fonts;
+  uint8_t m_nFonts;
+  uint8_t m_head = 0;  // Written only by the producer.
+  uint8_t m_tail = 0;  // Written only by the consumer.
+  uint8_t m_dropped = 0;  // Written only by the producer.
+};
+#endif  // SSD1306UTF8DrawQueue_h
@@ -0,0 +1,171 @@
+/**
+ * Copyright (c) 2011-2023 Bill Greiman
+ * This file is part of the Arduino SSD1306Ascii Library
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * @file SSD1306UTF8Queued.h
+ * @brief Queue bus traffic and send it in budgeted steps.
+ */
+#ifndef SSD1306UTF8Queued_h
+#define SSD1306UTF8Queued_h
+#include "SSD1306UTF8.h"
+//------------------------------------------------------------------------------
+/**
+ * @class SSD1306UTF8Queued
+ * @brief Add a send queue to a transport class.
+ *
+ * Drawing calls return after putting the command and data bytes in a
+ * queue.  Call service() or serviceMicros() from loop() to send part of
+ * the queue.  Drawing only waits for the bus if the queue is full.
+ *
+ * Data is sent with the transport's writeDisplayBuf().  Transports that
+ * do not override it send one byte at a time with writeDisplay().
+ *
+ * @tparam Transport A transport class such as SSD1306UTF8Wire.
+ * @tparam QueueSize Size of the queue in bytes, a multiple of eight.
+ *         Each byte of the queue uses nine bits of RAM.
+ */
+template <class Transport, uint16_t QueueSize = 256>
+class SSD1306UTF8Queued : public Transport {
+  static_assert(QueueSize % 8 == 0, "QueueSize must be a multiple of 8");
+
+ public:
+  using Transport::Transport;
+  /** @return Number of bytes waiting to be sent. */
+  uint16_t pending() const { return m_count; }
+  /**
+   * @brief Send bytes from the queue.
+   *
+   * A bus transaction is never left open between calls, so other
+   * devices may use the bus.
+   *
+   * @param[in] maxBytes Maximum number of command and data bytes to send.
+   * @return Number of bytes still waiting to be sent.
+   */
+  uint16_t service(uint16_t maxBytes) {
+    m_sending = true;
+    while (maxBytes && m_count) {
+      if (isCmd(m_head)) {
+        uint8_t b = m_queue[m_head];
+        pop(1);
+        Transport::writeDisplay(b, SSD1306_MODE_CMD);
+        maxBytes--;
+        continue;
+      }
+      // Send the run of data bytes before a command or the end of buf.
+      uint16_t n = QueueSize - m_head;
+      if (n > m_count) {
+        n = m_count;
+      }
+      if (n > maxBytes) {
+        n = maxBytes;
+      }
+      if (n > 255) {
+        n = 255;
+      }
+      uint16_t k = 1;
+      while (k < n && !isCmd(m_head + k)) {
+        k++;
+      }
+      const uint8_t* buf = m_queue + m_head;
+      pop(k);
+      Transport::writeDisplayBuf(buf, k);
+      maxBytes -= k;
+    }
+    Transport::writeDisplayFlush();
+    m_sending = false;
+    return m_count;
+  }
+  /**
+   * @brief Send bytes from the queue for a limited time.
+   *
+   * Bytes are sent in steps of I2C_REPEAT_CHUNK, the last step may end
+   * after maxMicros.
+   *
+   * @param[in] maxMicros Time limit in microseconds.
+   * @return Number of bytes still waiting to be sent.
+   */
+  uint16_t serviceMicros(uint32_t maxMicros) {
+    uint32_t m = micros();
+    while (m_count && (uint32_t)(micros() - m) < maxMicros) {
+      service(I2C_REPEAT_CHUNK);
+    }
+    return m_count;
+  }
+  /** @brief Send all queued bytes. */
+  void serviceAll() {
+    while (m_count) {
+      service(QueueSize);
+    }
+  }
+
+ protected:
+  void writeDisplay(uint8_t b, uint8_t mode) {
+    if (m_sending) {
+      // The transport's default writeDisplayBuf() sends with writeDisplay().
+      Transport::writeDisplay(b, mode);
+      return;
+    }
+    push(b, mode == SSD1306_MODE_CMD);
+  }
+  void writeDisplayRepeat(uint8_t b, uint8_t n) {
+    while (n--) {
+      push(b, false);
+    }
+  }
+  void writeDisplayBuf(const uint8_t* buf, uint8_t n) {
+    while (n--) {
+      push(*buf++, false);
+    }
+  }
+  // Queued bytes are sent by service().
+  void writeDisplayFlush() {}
+
+ private:
+  bool isCmd(uint16_t i) const { return m_cmd[i >> 3] & (1 << (i & 7)); }
+  void pop(uint16_t n) {
+    m_head = (m_head + n) % QueueSize;
+    m_count -= n;
+  }
+  void push(uint8_t b, bool cmd) {
+    if (m_count == QueueSize) {
+      // Make room, drawing waits for the bus.
+      service(QueueSize / 4);
+    }
+    uint16_t i = (m_head + m_count) % QueueSize;
+    m_queue[i] = b;
+    if (cmd) {
+      m_cmd[i >> 3] |= 1 << (i & 7);
+    } else {
+      m_cmd[i >> 3] &= ~(1 << (i & 7));
+    }
+    m_count++;
+  }
+
+  uint8_t m_queue[QueueSize];
+  uint8_t m_cmd[QueueSize / 8];  // Bit set if the byte is a command.
+  uint16_t m_head = 0;
+  uint16_t m_count = 0;
+  bool m_sending = false;  // True while service() calls the transport.
+};
+#endif  // SSD1306UTF8Queued_h
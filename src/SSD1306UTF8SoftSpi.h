@@ -78,12 +78,31 @@ class SSD1306UTF8SoftSpi : public SSD1306UTF8 {
   void writeDisplay(uint8_t b, uint8_t mode) {
     m_dcPin.write(mode != SSD1306_MODE_CMD);
     m_csPin.write(LOW);
+    writeByte(b);
+    m_csPin.write(HIGH);
+  }
+  void writeDisplayRepeat(uint8_t b, uint8_t n) {
+    m_dcPin.write(HIGH);
+    m_csPin.write(LOW);
+    while (n--) {
+      writeByte(b);
+    }
+    m_csPin.write(HIGH);
+  }
+  void writeDisplayBuf(const uint8_t* buf, uint8_t n) {
+    m_dcPin.write(HIGH);
+    m_csPin.write(LOW);
+    while (n--) {
+      writeByte(*buf++);
+    }
+    m_csPin.write(HIGH);
+  }
+  void writeByte(uint8_t b) {
     for (uint8_t m = 0X80; m; m >>= 1) {
       m_clkPin.write(LOW);
       m_dataPin.write(m & b);
       m_clkPin.write(HIGH);
     }
-    m_csPin.write(HIGH);
   }
 
  protected:
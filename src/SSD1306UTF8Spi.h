@@ -75,6 +75,37 @@ class SSD1306UTF8Spi : public SSD1306UTF8 {
     digitalWrite(m_cs, HIGH);
     SPI.endTransaction();
   }
+  void writeDisplayRepeat(uint8_t b, uint8_t n) {
+    // SPI.transfer() overwrites the buffer so fill it for each chunk.
+    uint8_t buf[16];
+    digitalWrite(m_dc, HIGH);
+    SPI.beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
+    digitalWrite(m_cs, LOW);
+    while (n) {
+      uint8_t k = n < sizeof(buf) ? n : sizeof(buf);
+      memset(buf, b, k);
+      SPI.transfer(buf, k);
+      n -= k;
+    }
+    digitalWrite(m_cs, HIGH);
+    SPI.endTransaction();
+  }
+  void writeDisplayBuf(const uint8_t* buf, uint8_t n) {
+    // SPI.transfer() overwrites the buffer so send a copy.
+    uint8_t tmp[16];
+    digitalWrite(m_dc, HIGH);
+    SPI.beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
+    digitalWrite(m_cs, LOW);
+    while (n) {
+      uint8_t k = n < sizeof(tmp) ? n : sizeof(tmp);
+      memcpy(tmp, buf, k);
+      SPI.transfer(tmp, k);
+      buf += k;
+      n -= k;
+    }
+    digitalWrite(m_cs, HIGH);
+    SPI.endTransaction();
+  }
 
   int8_t m_cs;
   int8_t m_dc;
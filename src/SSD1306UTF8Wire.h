@@ -102,6 +102,78 @@ class SSD1306UTF8Wire : public SSD1306UTF8 {
     m_oledWire.write(mode == SSD1306_MODE_CMD ? 0X00 : 0X40);
     m_oledWire.write(b);
     m_oledWire.endTransmission();
+#endif  // OPTIMIZE_I2C
+  }
+  void writeDisplayRepeat(uint8_t b, uint8_t n) {
+#if OPTIMIZE_I2C
+    // Append to an open data transaction, as for SSD1306_MODE_RAM_BUF.
+    while (n--) {
+      if (m_nData >= I2C_REPEAT_CHUNK) {
+        m_oledWire.endTransmission();
+        m_nData = 0;
+      }
+      if (m_nData == 0) {
+        m_oledWire.beginTransmission(m_i2cAddr);
+        m_oledWire.write(0X40);
+      }
+      m_oledWire.write(b);
+      m_nData++;
+    }
+#else   // OPTIMIZE_I2C
+    while (n) {
+      uint8_t k = n < I2C_REPEAT_CHUNK ? n : I2C_REPEAT_CHUNK;
+      m_oledWire.beginTransmission(m_i2cAddr);
+      m_oledWire.write(0X40);
+      for (uint8_t i = 0; i < k; i++) {
+        m_oledWire.write(b);
+      }
+      m_oledWire.endTransmission();
+      n -= k;
+    }
+#endif  // OPTIMIZE_I2C
+  }
+  void writeDisplayBuf(const uint8_t* buf, uint8_t n) {
+#if OPTIMIZE_I2C
+    if (m_nData >= I2C_REPEAT_CHUNK) {
+      m_oledWire.endTransmission();
+      m_nData = 0;
+    }
+    while (n) {
+      if (m_nData == 0) {
+        m_oledWire.beginTransmission(m_i2cAddr);
+        m_oledWire.write(0X40);
+      }
+      uint8_t k = I2C_REPEAT_CHUNK - m_nData;
+      if (k > n) {
+        k = n;
+      }
+      m_oledWire.write(buf, k);
+      buf += k;
+      n -= k;
+      m_nData += k;
+      if (m_nData >= I2C_REPEAT_CHUNK) {
+        m_oledWire.endTransmission();
+        m_nData = 0;
+      }
+    }
+#else   // OPTIMIZE_I2C
+    while (n) {
+      uint8_t k = n < I2C_REPEAT_CHUNK ? n : I2C_REPEAT_CHUNK;
+      m_oledWire.beginTransmission(m_i2cAddr);
+      m_oledWire.write(0X40);
+      m_oledWire.write(buf, k);
+      m_oledWire.endTransmission();
+      buf += k;
+      n -= k;
+    }
+#endif  // OPTIMIZE_I2C
+  }
+  void writeDisplayFlush() {
+#if OPTIMIZE_I2C
+    if (m_nData) {
+      m_oledWire.endTransmission();
+      m_nData = 0;
+    }
 #endif  // OPTIMIZE_I2C
   }
 
@@ -167,7 +167,7 @@ GLCDFONTDECL(HelloWorldUTF8) = {
     0x40, 0x20, 0x20, 0x60, 0x40, 0x40, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,                                                                         // 126
     0xFC, 0x04, 0x04, 0x04, 0x04, 0x04, 0xFC, 0x1C, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1C,                                                                         // 127
 
-    0x00, 0x03,             // utf8 type indicator
+    0x00, 0x13,             // utf8 type indicator
     0x0E,                   // utf8 glyph width
     0x00, 0x04,             // utf8 glyph count
 
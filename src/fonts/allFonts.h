@@ -41,16 +41,26 @@
 #ifndef _allFonts_h_
 #define _allFonts_h_
 
+/**
+ * Fonts are constexpr with C++11 and later so they may be read by
+ * constexpr functions, see utility/Prerender.h.
+ */
+#if __cplusplus >= 201103L
+#define GLCDFONT_CONST constexpr
+#else  // __cplusplus >= 201103L
+#define GLCDFONT_CONST const
+#endif  // __cplusplus >= 201103L
+
 #ifdef __AVR__
 #include <avr/pgmspace.h>
 /** declare a font for AVR. */
-#define GLCDFONTDECL(_n) static const uint8_t __attribute__((progmem)) _n[]
+#define GLCDFONTDECL(_n) static GLCDFONT_CONST uint8_t __attribute__((progmem)) _n[]
 inline uint8_t readFontByte(uint8_t const *addr) { return pgm_read_byte(addr); }
 inline uint16_t readFontBytes16(uint8_t const *addr) { return pgm_read_byte(addr) << 8 | pgm_read_byte(addr + 1); }
 inline uint32_t readFontBytes24(uint8_t const *addr) { return pgm_read_byte(addr) << 16 | (pgm_read_byte(addr + 1) << 8) | pgm_read_byte(addr + 2); }
 #else  // __AVR__
 /** declare a font. */
-#define GLCDFONTDECL(_n) static const uint8_t _n[]
+#define GLCDFONTDECL(_n) static GLCDFONT_CONST uint8_t _n[]
 /** Fake read from flash. */
 inline uint8_t readFontByte(uint8_t const *addr) { return *addr; }
 /** Fake read from flash. */
@@ -109,6 +119,7 @@ inline uint32_t readFontBytes24(uint8_t const *addr) { return (*addr) << 16 | (*
  *  bit1: Enable right and bottom padding
  *  bit2: Enable extension planes (this will make glyphs in glyph table 3 bytes each instead of 2)
  *  bit3: Enable 24bit address for glyph data
+ *  bit4: Glyph table is sorted by codepoint (enables binary search)
  */
 #define FONT_UTF8_GLYPH_WIDTH   2
 /* Glyph width when fixed width*/
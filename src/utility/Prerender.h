@@ -0,0 +1,341 @@
+/**
+ * Copyright (c) 2024 mr258876
+ *
+ * This file is part of the Arduino SSD1306UTF8 Library
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * @file Prerender.h
+ * @brief Compile-time rasterization of string literals.
+ */
+#ifndef Prerender_h
+#define Prerender_h
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Utf8Decoder.h"
+#if __cplusplus < 201402L
+#error Prerender.h requires C++14
+#endif  // __cplusplus < 201402L
+
+#ifdef __AVR__
+/** Place prerendered text in flash. */
+#define PRERENDER_PROGMEM __attribute__((progmem))
+#else  // __AVR__
+#define PRERENDER_PROGMEM
+#endif  // __AVR__
+//------------------------------------------------------------------------------
+/**
+ * @brief Define a string literal rendered by the compiler.
+ *
+ * The text is drawn with the default letter-spacing of the font and no
+ * invert.  Use SSD1306UTF8::drawPrerendered() to display it.  Compilation
+ * fails if a character is not in the font.
+ *
+ * @param[in] name Name of the PrerenderedText variable.
+ * @param[in] font A font from the fonts folder.
+ * @param[in] mag Magnification factor, one to four.
+ * @param[in] str The string literal, utf-8 for fonts with a utf-8
+ *            section, else codepage.
+ */
+#define PRERENDER_TEXT(name, font, mag, str)                              \
+  static_assert(Prerender::missing(font, mag, str) == 0,                  \
+                "character not in font: " str);                           \
+  static constexpr PrerenderedText<Prerender::width(font, mag, str),      \
+                                   Prerender::rows(font, mag)>            \
+      name PRERENDER_PROGMEM =                                            \
+          Prerender::render<Prerender::width(font, mag, str),             \
+                            Prerender::rows(font, mag)>(font, mag, str)
+/**
+ * @brief Define a string literal with glyphs resolved by the compiler.
+ *
+ * Use SSD1306UTF8::printResolved() to display it.  Unlike PRERENDER_TEXT(),
+ * magnification is applied when the text is printed.  Compilation fails
+ * if a character is not in the font.
+ *
+ * @param[in] name Name of the ResolvedText variable.
+ * @param[in] font A font from the fonts folder.
+ * @param[in] str The string literal, utf-8 for fonts with a utf-8
+ *            section, else codepage.
+ */
+#define RESOLVE_TEXT(name, font, str)                                     \
+  static_assert(Prerender::missing(font, 1, str) == 0,                    \
+                "character not in font: " str);                           \
+  static constexpr ResolvedText<Prerender::length(font, str)>             \
+      name PRERENDER_PROGMEM =                                            \
+          Prerender::resolve<Prerender::length(font, str)>(font, str)
+//------------------------------------------------------------------------------
+// Layout of a glyph in ResolvedText.
+/** Size of a resolved glyph. */
+#define RESOLVED_GLYPH_SIZE 8
+/** Big endian 24-bit codepoint. */
+#define RESOLVED_GLYPH_CP 0
+/** Big endian 24-bit offset of the glyph data in the font. */
+#define RESOLVED_GLYPH_DATA 3
+/** Width before magnification. */
+#define RESOLVED_GLYPH_WIDTH 6
+/** Thiele shift in bits 0-2, RESOLVED_GLYPH_SPACING, RESOLVED_GLYPH_BLANK. */
+#define RESOLVED_GLYPH_FLAGS 7
+/** Flag for one column of spacing before magnification. */
+#define RESOLVED_GLYPH_SPACING 0X08
+/** Flag for a non-font space. */
+#define RESOLVED_GLYPH_BLANK 0X10
+//------------------------------------------------------------------------------
+/**
+ * @struct ResolvedText
+ * @brief N glyphs of a font resolved at compile time.
+ */
+template <size_t N>
+struct ResolvedText {
+  /** The font. */
+  const uint8_t* font;
+  /** RESOLVED_GLYPH_SIZE bytes for each glyph. */
+  uint8_t glyphs[N ? RESOLVED_GLYPH_SIZE * N : 1];
+};
+//------------------------------------------------------------------------------
+/**
+ * @struct PrerenderedText
+ * @brief Page format bitmap, R rows of W columns.
+ */
+template <size_t W, uint8_t R>
+struct PrerenderedText {
+  static_assert(W < 256, "prerendered text is too wide");
+  /** Bitmap, one row after another. */
+  uint8_t data[W * R ? W * R : 1];
+};
+//------------------------------------------------------------------------------
+/**
+ * @class Prerender
+ * @brief constexpr versions of the glyph lookup and transforms in
+ *        SSD1306UTF8.
+ */
+class Prerender {
+ public:
+  /** Location and layout of one glyph. */
+  struct Glyph {
+    size_t data;      // Offset of glyph data in the font.
+    uint8_t w;        // Width before magnification.
+    uint8_t nr;       // Height in rows before magnification.
+    uint8_t shift;    // Thiele shift of the last row.
+    uint8_t spacing;  // Spacing columns after magnification.
+    bool found;       // Glyph is in the font.
+    bool blank;       // Non-font space.
+  };
+  /** Codepoint returned by next() for malformed utf-8. */
+  static constexpr uint32_t kBad = 0XFFFFFFFF;
+
+  static constexpr uint16_t read16(const uint8_t* f, size_t i) {
+    return f[i] << 8 | f[i + 1];
+  }
+  static constexpr uint32_t read24(const uint8_t* f, size_t i) {
+    return (uint32_t)f[i] << 16 | f[i + 1] << 8 | f[i + 2];
+  }
+  static constexpr bool utf8(const uint8_t* f) {
+    return read16(f, FONT_LENGTH) > 1 && read16(f, FONT_LENGTH) < 5;
+  }
+  /** @return The character at str + i and advance i. */
+  static constexpr uint32_t next(const uint8_t* f, const char* str,
+                                 size_t& i) {
+    uint8_t b = str[i++];
+    if (b < 0X80 || !utf8(f)) {
+      // ASCII or codepage font.
+      return b;
+    }
+    uint32_t cp = 0;
+    uint8_t state = UTF8_ACCEPT;
+    for (;;) {
+      uint8_t type = b < 0X80 ? 0 : utf8DfaTable[b - 0X80];
+      cp = state != UTF8_ACCEPT ? (b & 0X3F) | (cp << 6) : (0XFF >> type) & b;
+      state = utf8DfaTable[128 + state + type];
+      if (state == UTF8_ACCEPT) {
+        return cp;
+      }
+      if (state == UTF8_REJECT || !str[i]) {
+        return kBad;
+      }
+      b = str[i++];
+    }
+  }
+  /** @return Layout of the glyph for cp, found is false if missing. */
+  static constexpr Glyph glyph(const uint8_t* f, uint8_t mag, uint32_t cp) {
+    Glyph g{};
+    uint16_t type = read16(f, FONT_LENGTH);
+    uint8_t h = f[FONT_HEIGHT];
+    g.nr = (h + 7) / 8;
+    if (cp < 0X80 || !utf8(f)) {
+      uint8_t first = f[FONT_FIRST_CHAR];
+      uint8_t count = f[FONT_CHAR_COUNT];
+      size_t base =
+          FONT_WIDTH_TABLE + (utf8(f) ? FONT_UTF8_EXTRA_HEADER_LEN : 0);
+      g.w = f[FONT_WIDTH];
+      g.spacing = (type == 1 || type == 3) ? 0 : mag;
+      if (first <= cp && cp < (first + count)) {
+        uint8_t ch = cp - first;
+        if (type < 4) {
+          g.data = base + g.nr * g.w * ch;
+        } else {
+          if (h & 7) {
+            g.shift = 8 - (h & 7);
+          }
+          size_t index = 0;
+          for (uint8_t i = 0; i < ch; i++) {
+            index += f[base + i];
+          }
+          g.w = f[base + ch];
+          g.data = base + g.nr * index + count;
+        }
+        g.found = true;
+      } else if (ENABLE_NONFONT_SPACE && cp == ' ') {
+        g.found = g.blank = true;
+      }
+      return g;
+    }
+    size_t utf8 = read16(f, FONT_UTF8_HEADER_POS);
+    uint16_t settings = read16(f, utf8);
+    bool fixed = settings & 0b1;
+    bool ext = settings & 0b100;
+    bool addr24 = settings & 0b1000;
+    uint8_t metaLen = (ext ? 3 : 2) + (fixed ? 0 : 1) + (addr24 ? 3 : 2);
+    uint16_t count = read16(f, utf8 + FONT_UTF8_CHAR_COUNT);
+    for (uint16_t i = 0; i < count; i++) {
+      size_t p = utf8 + FONT_UTF8_GLYPH_TABLE + (size_t)i * metaLen;
+      if ((ext ? read24(f, p) : read16(f, p)) == cp) {
+        g.w = fixed ? f[utf8 + FONT_UTF8_GLYPH_WIDTH] : f[p + (ext ? 3 : 2)];
+        g.data = addr24 ? read24(f, p + metaLen - 3)
+                        : read16(f, p + metaLen - 2);
+        g.spacing = (settings & 0b10) ? mag : 0;
+        if (!fixed && (h & 7)) {
+          g.shift = 8 - (h & 7);
+        }
+        g.found = true;
+        break;
+      }
+    }
+    return g;
+  }
+  /** @return One plus the index of the first missing character or zero. */
+  static constexpr size_t missing(const uint8_t* f, uint8_t mag,
+                                  const char* str) {
+    size_t i = 0;
+    while (str[i]) {
+      size_t n = i;
+      if (!glyph(f, mag, next(f, str, i)).found) {
+        return n + 1;
+      }
+    }
+    return 0;
+  }
+  /** @return Width of str in pixels. */
+  static constexpr size_t width(const uint8_t* f, uint8_t mag,
+                                const char* str) {
+    size_t w = 0;
+    size_t i = 0;
+    while (str[i]) {
+      Glyph g = glyph(f, mag, next(f, str, i));
+      if (g.found && g.w) {
+        w += mag * g.w + g.spacing;
+      }
+    }
+    return w;
+  }
+  /** @return Number of glyphs in str. */
+  static constexpr size_t length(const uint8_t* f, const char* str) {
+    size_t n = 0;
+    size_t i = 0;
+    while (str[i]) {
+      if (glyph(f, 1, next(f, str, i)).found) {
+        n++;
+      }
+    }
+    return n;
+  }
+  /** @return The glyphs of str. */
+  template <size_t N>
+  static constexpr ResolvedText<N> resolve(const uint8_t* f,
+                                           const char* str) {
+    ResolvedText<N> t{};
+    t.font = f;
+    size_t n = 0;
+    size_t i = 0;
+    while (str[i]) {
+      uint32_t cp = next(f, str, i);
+      Glyph g = glyph(f, 1, cp);
+      if (!g.found) {
+        continue;
+      }
+      uint8_t* p = t.glyphs + RESOLVED_GLYPH_SIZE * n++;
+      for (uint8_t k = 0; k < 3; k++) {
+        p[RESOLVED_GLYPH_CP + k] = cp >> (16 - 8 * k);
+        p[RESOLVED_GLYPH_DATA + k] = g.data >> (16 - 8 * k);
+      }
+      p[RESOLVED_GLYPH_WIDTH] = g.w;
+      p[RESOLVED_GLYPH_FLAGS] = g.shift |
+                                (g.spacing ? RESOLVED_GLYPH_SPACING : 0) |
+                                (g.blank ? RESOLVED_GLYPH_BLANK : 0);
+    }
+    return t;
+  }
+  /** @return Height of text in rows of eight pixels. */
+  static constexpr uint8_t rows(const uint8_t* f, uint8_t mag) {
+    return mag * ((f[FONT_HEIGHT] + 7) / 8);
+  }
+  /** @return b with each pixel repeated mag times. */
+  static constexpr uint32_t magnify(uint8_t b, uint8_t mag) {
+    uint32_t e = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+      if (b & (1 << i)) {
+        e |= ((1UL << mag) - 1) << (i * mag);
+      }
+    }
+    return e;
+  }
+  /** @return str drawn as by SSD1306UTF8::print(). */
+  template <size_t W, uint8_t R>
+  static constexpr PrerenderedText<W, R> render(const uint8_t* f,
+                                                uint8_t mag,
+                                                const char* str) {
+    PrerenderedText<W, R> t{};
+    size_t x = 0;
+    size_t i = 0;
+    while (str[i]) {
+      Glyph g = glyph(f, mag, next(f, str, i));
+      if (!g.found || !g.w) {
+        continue;
+      }
+      for (uint8_t r = 0; r < g.nr; r++) {
+        uint8_t rs = (r + 1) == g.nr ? g.shift : 0;
+        for (uint8_t c = 0; c < g.w; c++) {
+          uint8_t b = g.blank ? 0 : f[g.data + c + r * g.w] >> rs;
+          uint32_t e = magnify(b, mag);
+          for (uint8_t m = 0; m < mag; m++) {
+            for (uint8_t k = 0; k < mag; k++) {
+              t.data[(r * mag + m) * W + x + c * mag + k] = e >> (8 * m);
+            }
+          }
+        }
+      }
+      x += mag * g.w + g.spacing;
+    }
+    return t;
+  }
+};
+#endif  // Prerender_h
@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2024 mr258876
+ *
+ * This file is part of the Arduino SSD1306UTF8 Library
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+/**
+ * @file Utf8Decoder.h
+ * @brief Table driven UTF-8 decoder.
+ */
+#ifndef Utf8Decoder_h
+#define Utf8Decoder_h
+#include <stdint.h>
+
+#include "../fonts/allFonts.h"
+//------------------------------------------------------------------------------
+// Values returned by Utf8Decoder::decode().
+/** A codepoint is complete. */
+#define UTF8_ACCEPT 0
+/** The byte is not valid at this point of a sequence. */
+#define UTF8_REJECT 12
+//------------------------------------------------------------------------------
+/**
+ * DFA from Bjoern Hoehrmann, "Flexible and Economical UTF-8 Decoder".
+ *
+ * The first 128 bytes map bytes 0X80 - 0XFF to character classes, bytes
+ * below 0X80 are class zero.  The remaining 108 bytes map state + class
+ * to the next state.  Overlong forms, surrogates and codepoints above
+ * U+10FFFF are rejected.
+ */
+GLCDFONTDECL(utf8DfaTable) = {
+    // Character classes for 0X80 - 0XFF.
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    8, 8, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    10, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 3, 3,
+    11, 6, 6, 6, 5, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+    // Transitions, state + class.
+    0, 12, 24, 36, 60, 96, 84, 12, 12, 12, 48, 72,
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+    12, 0, 12, 12, 12, 12, 12, 0, 12, 0, 12, 12,
+    12, 24, 12, 12, 12, 12, 12, 24, 12, 24, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 24, 12, 12, 12, 12,
+    12, 24, 12, 12, 12, 12, 12, 12, 12, 24, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 36, 12, 36, 12, 12,
+    12, 36, 12, 12, 12, 12, 12, 36, 12, 36, 12, 12,
+    12, 36, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12};
+//------------------------------------------------------------------------------
+/**
+ * @class Utf8Decoder
+ * @brief Decode and validate UTF-8 one byte at a time.
+ */
+class Utf8Decoder {
+ public:
+  /**
+   * @brief Feed one byte to the decoder.
+   *
+   * @param[in] b The byte.
+   * @return UTF8_ACCEPT if codepoint() is complete, UTF8_REJECT for
+   *         malformed input, any other value if more bytes are needed.
+   *         Call reset() after UTF8_REJECT.
+   */
+  uint8_t decode(uint8_t b) {
+    uint8_t type = b < 0X80 ? 0 : readFontByte(utf8DfaTable + b - 0X80);
+    m_codepoint = m_state != UTF8_ACCEPT ? (b & 0X3F) | (m_codepoint << 6)
+                                         : (0XFF >> type) & b;
+    m_state = readFontByte(utf8DfaTable + 128 + m_state + type);
+    return m_state;
+  }
+  /** @return The last complete codepoint. */
+  uint32_t codepoint() const { return m_codepoint; }
+  /** @return true if a sequence has been started but is not complete. */
+  bool pending() const { return m_state != UTF8_ACCEPT; }
+  /** @brief Discard a partial sequence. */
+  void reset() { m_state = UTF8_ACCEPT; }
+
+ private:
+  uint32_t m_codepoint = 0;
+  uint8_t m_state = UTF8_ACCEPT;
+};
+#endif  // Utf8Decoder_h